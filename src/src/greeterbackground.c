@@ -6,8 +6,19 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <string.h>
 #include <X11/Xatom.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #include "greeterbackground.h"
+#include "greeterimagecache.h"
+#include "greeteriobroker.h"
+#include "greeterblend.h"
+#include "greeterscale.h"
+#include "greetertrace.h"
 
 typedef enum
 {
@@ -84,24 +95,97 @@ typedef struct
 {
     gint ref_count;
     BackgroundType type;
+    /* BACKGROUND_TYPE_IMAGE only: image is being decoded by loader thread */
+    gboolean loading;
+    /* BACKGROUND_TYPE_IMAGE only: cancels loading of image nobody waits for, NULL if not loading */
+    GCancellable* cancellable;
+    /* No transparent pixels: painted with CAIRO_OPERATOR_SOURCE, images are CAIRO_FORMAT_RGB24 */
+    gboolean opaque;
+    /* Key in GreeterBackgroundPrivate.backgrounds, NULL if not registered */
+    gchar* key;
+    /* BACKGROUND_TYPE_IMAGE only: copy of image uploaded to X server, see background_get_server_image() */
+    cairo_surface_t* server_image;
+    /* BACKGROUND_TYPE_IMAGE only: image was dropped by residency manager, see background_evict() */
+    gboolean evicted;
+    /* BACKGROUND_TYPE_IMAGE only: used to load image again after eviction */
+    struct
+    {
+        gchar* path;
+        ScalingMode mode;
+        gint width;
+        gint height;
+    } source;
+    /* Last time background was displayed by enabled monitor (monotonic time) */
+    gint64 last_visible;
     union
     {
-        GdkPixbuf* image;
+        /* Image surface in drawing format, converted once by loader */
+        cairo_surface_t* image;
         GdkRGBA color;
     } options;
 } Background;
 
+/* Image decoding task, created in main thread and processed by loader pool */
+typedef struct
+{
+    GreeterBackground* object;
+    /* Background to fill, referenced */
+    Background* background;
+    gchar* path;
+    ScalingMode mode;
+    gint width;
+    gint height;
+    /* Directory of scaled images cache, can be NULL */
+    gchar* cache_dir;
+    gint64 queued;
+} BackgroundLoadTask;
+
+/* Image of background that is not resident (evicted or still loading), loaded by root pixmap thread */
+typedef struct
+{
+    gchar* path;
+    ScalingMode mode;
+    gint width;
+    gint height;
+} XRootSource;
+
+/* Root pixmap composed in worker thread from monitors backgrounds */
+typedef struct
+{
+    gint width;
+    gint height;
+    gsize monitors_size;
+    GdkRectangle* rects;
+    /* Monitor fallback color, painted under background: shows through transparent images
+     * and replaces images that can not be loaded */
+    GdkRGBA* colors;
+    /* Resident backgrounds, NULL if image must be loaded from sources[i] */
+    Background** backgrounds;
+    XRootSource* sources;
+    gchar* cache_dir;
+    /* Result, RGB24 image of screen size.
+     * Default (theme) backgrounds are rendered into it by main thread before thread starts. */
+    cairo_surface_t* image;
+} XRootTask;
+
 typedef struct
 {
     GreeterBackground* object;
     gint number;
     gchar* name;
     GdkRectangle geometry;
+    gint scale;
+    /* Config used to create this monitor */
+    const MonitorConfig* config;
     GtkWindow* window;
     gulong window_draw_handler_id;
 
     /* Configured background */
     Background* background_configured;
+    /* Solid color displayed until first image is loaded */
+    Background* background_fallback;
+    /* Background waiting for its image to be loaded */
+    Background* background_pending;
     /* Current monitor background: &background_configured or &background_custom
      * Monitors with type = BACKGROUND_TYPE_SKIP have background = NULL */
     Background* background;
@@ -119,6 +203,16 @@ typedef struct
         gint64 started;
         /* Current stage */
         gdouble stage;
+
+        /* Crossfade result, NULL if backgrounds can not be blended directly */
+        cairo_surface_t* surface;
+        /* Pixel rows used as blend sources for color backgrounds */
+        guint32* from_row;
+        guint32* to_row;
+
+        /* Repaint statistics, logged once when transition is finished */
+        guint frames;
+        guint64 pixels;
     } transition;
 } Monitor;
 
@@ -180,6 +274,40 @@ struct _GreeterBackgroundPrivate
 
     /* Name => transition function, inited in set_monitor_config() */
     GHashTable* transition_types;
+
+    /* List of <BackgroundLoadTask*> waiting to be submitted to IO broker */
+    GList* loader_queue;
+    /* Directory to store scaled images between greeter runs */
+    gchar* cache_dir;
+
+    /* Image backgrounds shared by monitors and reused between connections:
+     * key (see background_get_key()) => <Background*>, one reference is owned by table */
+    GHashTable* backgrounds;
+    /* Timer to remove unused backgrounds from table */
+    guint backgrounds_sweep_id;
+
+    /* Recently used and prefetched user backgrounds <Background*>, most recent first */
+    GQueue* custom_cache;
+    /* Memory limit for loaded images in custom_cache (bytes) */
+    gsize custom_cache_limit;
+    /* User backgrounds <Background*> of last prefetch request, referenced: their loading is not cancelled */
+    GSList* prefetched;
+
+    /* Thread composing root pixmap, see greeter_background_prepare_xroot() */
+    GThread* xroot_thread;
+
+    /* Keep images in X server pixmaps, expose and transitions do not send pixels */
+    gboolean server_images;
+
+    /* Repaint statistics for debug log */
+    guint repaints_count;
+    guint64 repainted_pixels;
+
+    /* Residency manager: invisible images are dropped, memory_limit (bytes) bounds the rest */
+    gsize memory_limit;
+    guint residency_id;
+    /* Images loaded since last residency check: decoder buffers can be returned to system */
+    gboolean residency_trim;
 };
 
 enum
@@ -198,6 +326,16 @@ static const gchar* DBUS_UPOWER_PROP_LID_IS_CLOSED  = "LidIsClosed";
 
 static const gchar* ACTIVE_MONITOR_CURSOR_TAG       = "#cursor";
 
+static const gchar* BACKGROUND_CACHE_SUBDIR         = "backgrounds";
+/* Unused backgrounds are kept for this time (seconds), e.g. to make monitor replugging instant */
+static const guint BACKGROUND_REGISTRY_TIMEOUT      = 60;
+/* Default memory limit for user backgrounds cache */
+static const gsize BACKGROUND_CUSTOM_CACHE_LIMIT    = 64*1024*1024;
+/* Disk space used by scaled images cache, least recently used images are removed at startup */
+static const gsize BACKGROUND_DISK_CACHE_LIMIT      = 256*1024*1024;
+/* Images from stalled file systems are given up after this time (ms) of reading and decoding */
+static const guint BACKGROUND_LOAD_TIMEOUT          = 15000;
+
 G_DEFINE_TYPE_WITH_PRIVATE(GreeterBackground, greeter_background, G_TYPE_OBJECT);
 
 void greeter_background_set_active_monitor_config   (GreeterBackground* background,
@@ -233,10 +371,35 @@ static void greeter_background_dbus_changed_cb      (GDBusProxy* proxy,
                                                      GVariant* changed_properties,
                                                      const gchar* const* invalidated_properties,
                                                      GreeterBackground* background);
+static void greeter_background_setup_monitors       (GreeterBackground* background,
+                                                     Monitor* old_monitors,
+                                                     gsize old_monitors_size,
+                                                     const Monitor* old_active);
+static Monitor* greeter_background_take_monitor     (Monitor* old_monitors,
+                                                     gsize old_monitors_size,
+                                                     const Monitor* monitor);
 static void greeter_background_monitors_changed_cb  (GdkScreen* screen,
                                                      GreeterBackground* background);
 static void greeter_background_child_destroyed_cb   (GtkWidget* child,
                                                      GreeterBackground* background);
+static void greeter_background_queue_image          (GreeterBackground* background,
+                                                     Background* bg,
+                                                     const gchar* path,
+                                                     ScalingMode mode,
+                                                     gint width, gint height);
+static void greeter_background_start_loading        (GreeterBackground* background);
+static void greeter_background_schedule_sweep       (GreeterBackground* background);
+static gboolean greeter_background_sweep_cb         (GreeterBackground* background);
+static void greeter_background_cache_custom         (GreeterBackground* background,
+                                                     Background* bg);
+static void greeter_background_trim_custom_cache    (GreeterBackground* background);
+static void greeter_background_schedule_residency   (GreeterBackground* background);
+static gboolean greeter_background_residency_cb     (GreeterBackground* background);
+static gboolean greeter_background_is_visible       (GreeterBackground* background,
+                                                     const Background* bg);
+static gboolean greeter_background_is_wanted        (GreeterBackground* background,
+                                                     const Background* bg);
+static void greeter_background_cancel_loading       (GreeterBackground* background);
 
 /* struct BackgroundConfig */
 static gboolean background_config_initialize        (BackgroundConfig* config,
@@ -253,14 +416,44 @@ static MonitorConfig* monitor_config_copy           (const MonitorConfig* source
 
 /* struct Background */
 static Background* background_new                   (const BackgroundConfig* config,
-                                                     const Monitor* monitor,
-                                                     GHashTable* images_cache);
+                                                     const Monitor* monitor);
+static gchar* background_get_key                    (const BackgroundConfig* config,
+                                                     const Monitor* monitor);
 static Background* background_ref                   (Background* bg);
 static void background_unref                        (Background** bg);
+static void background_release                      (Background* bg);
+static cairo_surface_t* background_get_server_image (Background* bg,
+                                                     const Monitor* monitor);
+static void background_draw                         (const Background* bg,
+                                                     const GdkRectangle* area,
+                                                     cairo_t* cr);
+static gsize background_get_size                    (const Background* bg);
+static void background_evict                        (Background* bg);
+static gboolean background_reload                   (Background* bg,
+                                                     GreeterBackground* background);
 static void background_finalize                     (Background* bg);
 
+/* struct BackgroundLoadTask */
+static gpointer background_load_task_run            (const gchar* path,
+                                                     BackgroundLoadTask* task,
+                                                     GError** error);
+static void background_load_task_finished_cb        (const gchar* path,
+                                                     cairo_surface_t* image,
+                                                     const GError* error,
+                                                     BackgroundLoadTask* task);
+static void background_load_task_free               (BackgroundLoadTask* task);
+
+static gpointer background_trim_disk_cache          (const gchar* cache_dir,
+                                                     gpointer limit,
+                                                     GError** error);
+
+static gpointer xroot_task_run                      (XRootTask* task);
+static void xroot_task_free                         (XRootTask* task);
+
 /* struct Monitor */
 static void monitor_finalize                        (Monitor* info);
+static void monitor_move                            (Monitor* dest,
+                                                     Monitor* source);
 static void monitor_set_background                  (Monitor* monitor,
                                                      Background* background);
 static void monitor_start_transition                (Monitor* monitor,
@@ -272,24 +465,45 @@ static gboolean monitor_transition_cb               (GtkWidget *widget,
                                                      Monitor* monitor);
 static void monitor_transition_draw_alpha           (const Monitor* monitor,
                                                      cairo_t* cr);
+static void monitor_transition_prepare_blend        (Monitor* monitor);
+static void monitor_transition_blend                (Monitor* monitor);
+static guint64 monitor_add_dirty_area               (const Monitor* monitor,
+                                                     cairo_t* cr,
+                                                     guint* rects_count);
+static guint64 monitor_add_dirty_rect               (const Monitor* monitor,
+                                                     cairo_t* cr,
+                                                     gdouble x1, gdouble y1,
+                                                     gdouble x2, gdouble y2);
+static gboolean monitor_set_background_source       (const Monitor* monitor,
+                                                     Background* background,
+                                                     cairo_t* cr);
 static void monitor_draw_background                 (const Monitor* monitor,
-                                                     const Background* background,
+                                                     Background* background,
                                                      cairo_t* cr);
 static gboolean monitor_window_draw_cb              (GtkWidget* widget,
                                                      cairo_t* cr,
-                                                     const Monitor* monitor);
+                                                     Monitor* monitor);
 static gboolean monitor_window_enter_notify_cb      (GtkWidget* widget,
                                                      GdkEventCrossing* event,
                                                      const Monitor* monitor);
 
-static GdkPixbuf* scale_image_file                  (const gchar* path,
+static cairo_surface_t* scale_image_file            (const gchar* path,
+                                                     ScalingMode mode,
+                                                     gint width, gint height,
+                                                     const gchar* cache_dir);
+static GdkPixbuf* load_image_file                   (const gchar* path,
                                                      ScalingMode mode,
                                                      gint width, gint height,
-                                                     GHashTable* cache);
+                                                     GError** error);
+static cairo_surface_t* image_surface_drop_alpha    (cairo_surface_t* surface);
 static GdkPixbuf* scale_image                       (GdkPixbuf* source,
                                                      ScalingMode mode,
                                                      gint width, gint height);
 static cairo_surface_t* create_root_surface         (GdkScreen* screen);
+static void put_root_image                          (cairo_surface_t* root,
+                                                     cairo_surface_t* image,
+                                                     const GdkRectangle* rects,
+                                                     gsize rects_size);
 static void set_root_pixmap_id                      (GdkScreen* screen,
                                                      Display* display,
                                                      Pixmap xpixmap);
@@ -361,6 +575,25 @@ greeter_background_init(GreeterBackground* self)
     self->priv->laptop_monitors = NULL;
     self->priv->laptop_upower_proxy = NULL;
     self->priv->laptop_lid_closed = FALSE;
+
+    self->priv->loader_queue = NULL;
+    self->priv->cache_dir = NULL;
+
+    self->priv->backgrounds = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)background_release);
+    self->priv->backgrounds_sweep_id = 0;
+
+    self->priv->custom_cache = g_queue_new();
+    self->priv->custom_cache_limit = BACKGROUND_CUSTOM_CACHE_LIMIT;
+
+    self->priv->xroot_thread = NULL;
+    self->priv->server_images = FALSE;
+
+    self->priv->repaints_count = 0;
+    self->priv->repainted_pixels = 0;
+
+    self->priv->memory_limit = G_MAXSIZE;
+    self->priv->residency_id = 0;
+    self->priv->residency_trim = FALSE;
 }
 
 GreeterBackground*
@@ -374,6 +607,48 @@ greeter_background_new(GtkWidget* child)
 	return background;
 }
 
+void
+greeter_background_set_cache_dir(GreeterBackground* background,
+                                 const gchar* path)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    GreeterBackgroundPrivate* priv = background->priv;
+
+    g_free(priv->cache_dir);
+    priv->cache_dir = path ? g_build_filename(path, BACKGROUND_CACHE_SUBDIR, NULL) : NULL;
+
+    if(priv->cache_dir)
+        greeter_io_broker_submit(priv->cache_dir, 0, NULL, (GreeterIOFunc)background_trim_disk_cache,
+                                 GSIZE_TO_POINTER(BACKGROUND_DISK_CACHE_LIMIT), NULL, NULL, NULL, NULL);
+}
+
+void
+greeter_background_set_server_images(GreeterBackground* background,
+                                     gboolean enabled)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    g_debug("[Background] Server-side images: %s", enabled ? "enabled" : "disabled");
+    background->priv->server_images = enabled;
+}
+
+void
+greeter_background_set_memory_limit(GreeterBackground* background,
+                                    gsize limit)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    background->priv->memory_limit = limit;
+    greeter_background_schedule_residency(background);
+}
+
+void
+greeter_background_set_custom_cache_limit(GreeterBackground* background,
+                                          gsize limit)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    background->priv->custom_cache_limit = limit;
+    greeter_background_trim_custom_cache(background);
+}
+
 void
 greeter_background_set_active_monitor_config(GreeterBackground* background,
                                              const gchar* value)
@@ -503,6 +778,26 @@ greeter_background_connect(GreeterBackground* background,
         greeter_background_disconnect(background);
 
     priv->screen = screen;
+    greeter_background_setup_monitors(background, NULL, 0, NULL);
+
+    priv->screen_monitors_changed_handler_id = g_signal_connect(G_OBJECT(screen), "monitors-changed",
+                                                                G_CALLBACK(greeter_background_monitors_changed_cb),
+                                                                background);
+}
+
+/* Create monitors for current screen state.
+ * Monitors from old_monitors with same name, geometry and config are moved to new array with
+ * their windows and backgrounds, caller must finalize the rest. */
+static void
+greeter_background_setup_monitors(GreeterBackground* background,
+                                  Monitor* old_monitors,
+                                  gsize old_monitors_size,
+                                  const Monitor* old_active)
+{
+    GreeterBackgroundPrivate* priv = background->priv;
+    GdkScreen* screen = priv->screen;
+
+    GREETER_TRACE_BEGIN("background_setup_monitors");
     priv->monitors_size = gdk_screen_get_n_monitors(screen);
     priv->monitors = g_new0(Monitor, priv->monitors_size);
     priv->monitors_map = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
@@ -512,7 +807,6 @@ greeter_background_connect(GreeterBackground* background,
     /* Used to track situation when all monitors marked as "#skip" */
     Monitor* first_not_skipped_monitor = NULL;
 
-    GHashTable* images_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
     gint i;
     for(i = 0; i < priv->monitors_size; ++i)
     {
@@ -522,6 +816,7 @@ greeter_background_connect(GreeterBackground* background,
         monitor->object = background;
         monitor->name = g_strdup(gdk_screen_get_monitor_plug_name(screen, i));
         monitor->number = i;
+        monitor->scale = gdk_screen_get_monitor_scale_factor(screen, i);
 
         const gchar* printable_name = monitor->name ? monitor->name : "<unknown>";
 
@@ -556,31 +851,62 @@ greeter_background_connect(GreeterBackground* background,
         if(!first_not_skipped_monitor)
             first_not_skipped_monitor = monitor;
 
-        monitor->window = GTK_WINDOW(gtk_window_new(GTK_WINDOW_TOPLEVEL));
-        gtk_window_set_type_hint(monitor->window, GDK_WINDOW_TYPE_HINT_DESKTOP);
-        gtk_window_set_keep_below(monitor->window, TRUE);
-        gtk_window_set_resizable(monitor->window, FALSE);
-        gtk_widget_set_app_paintable(GTK_WIDGET(monitor->window), TRUE);
-        gtk_window_set_screen(monitor->window, screen);
-        gtk_widget_set_size_request(GTK_WIDGET(monitor->window), monitor->geometry.width, monitor->geometry.height);
-        gtk_window_move(monitor->window, monitor->geometry.x, monitor->geometry.y);
-        gtk_widget_show(GTK_WIDGET(monitor->window));
-        monitor->window_draw_handler_id = g_signal_connect(G_OBJECT(monitor->window), "draw",
-                                                           G_CALLBACK(monitor_window_draw_cb),
-                                                           monitor);
-
-        gchar* window_name = monitor->name ? g_strdup_printf("monitor-%s", monitor->name) : g_strdup_printf("monitor-%d", i);
-        gtk_widget_set_name(GTK_WIDGET(monitor->window), window_name);
-        gtk_style_context_add_class(gtk_widget_get_style_context(GTK_WIDGET(monitor->window)), "lightdm-gtk-greeter");
-        g_free(window_name);
-
-        GSList* item;
-        for(item = priv->accel_groups; item != NULL; item = g_slist_next(item))
-            gtk_window_add_accel_group(monitor->window, item->data);
-
-        if(priv->follow_cursor)
-            g_signal_connect(G_OBJECT(monitor->window), "enter-notify-event",
-                             G_CALLBACK(monitor_window_enter_notify_cb), monitor);
+        monitor->config = config;
+
+        Monitor* old_monitor = greeter_background_take_monitor(old_monitors, old_monitors_size, monitor);
+        if(old_monitor)
+        {
+            g_debug("[Background] Monitor %s #%d is not changed, keeping its window", printable_name, i);
+            if(old_monitor == old_active)
+                priv->active_monitor = monitor;
+            monitor_move(monitor, old_monitor);
+            monitor->number = i;
+        }
+        else
+        {
+            monitor->window = GTK_WINDOW(gtk_window_new(GTK_WINDOW_TOPLEVEL));
+            gtk_window_set_type_hint(monitor->window, GDK_WINDOW_TYPE_HINT_DESKTOP);
+            gtk_window_set_keep_below(monitor->window, TRUE);
+            gtk_window_set_resizable(monitor->window, FALSE);
+            gtk_widget_set_app_paintable(GTK_WIDGET(monitor->window), TRUE);
+            gtk_window_set_screen(monitor->window, screen);
+            gtk_widget_set_size_request(GTK_WIDGET(monitor->window), monitor->geometry.width, monitor->geometry.height);
+            gtk_window_move(monitor->window, monitor->geometry.x, monitor->geometry.y);
+            gtk_widget_show(GTK_WIDGET(monitor->window));
+            monitor->window_draw_handler_id = g_signal_connect(G_OBJECT(monitor->window), "draw",
+                                                               G_CALLBACK(monitor_window_draw_cb),
+                                                               monitor);
+
+            gchar* window_name = monitor->name ? g_strdup_printf("monitor-%s", monitor->name) : g_strdup_printf("monitor-%d", i);
+            gtk_widget_set_name(GTK_WIDGET(monitor->window), window_name);
+            gtk_style_context_add_class(gtk_widget_get_style_context(GTK_WIDGET(monitor->window)), "lightdm-gtk-greeter");
+            g_free(window_name);
+
+            GSList* item;
+            for(item = priv->accel_groups; item != NULL; item = g_slist_next(item))
+                gtk_window_add_accel_group(monitor->window, item->data);
+
+            if(priv->follow_cursor)
+                g_signal_connect(G_OBJECT(monitor->window), "enter-notify-event",
+                                 G_CALLBACK(monitor_window_enter_notify_cb), monitor);
+
+            /* Solid color painted right away, images are decoded by loader pool */
+            const BackgroundConfig* fallback_config = &DEFAULT_MONITOR_CONFIG.bg;
+            if(config->bg.type == BACKGROUND_TYPE_COLOR)
+                fallback_config = &config->bg;
+            else if(priv->default_config->bg.type == BACKGROUND_TYPE_COLOR)
+                fallback_config = &priv->default_config->bg;
+            monitor->background_fallback = background_new(fallback_config, monitor);
+            monitor_set_background(monitor, monitor->background_fallback);
+
+            monitor->background_configured = background_new(&config->bg, monitor);
+            if(!monitor->background_configured)
+                monitor->background_configured = background_new(&DEFAULT_MONITOR_CONFIG.bg, monitor);
+            monitor_set_background(monitor, monitor->background_configured);
+
+            if(config->transition.duration && config->transition.func)
+                monitor->transition.config = config->transition;
+        }
 
         if(config->user_bg)
             priv->customized_monitors = g_slist_prepend(priv->customized_monitors, monitor);
@@ -588,19 +914,10 @@ greeter_background_connect(GreeterBackground* background,
         if(config->laptop)
             priv->laptop_monitors = g_slist_prepend(priv->laptop_monitors, monitor);
 
-        monitor->background_configured = background_new(&config->bg, monitor, images_cache);
-        if(!monitor->background_configured)
-            monitor->background_configured = background_new(&DEFAULT_MONITOR_CONFIG.bg, monitor, images_cache);
-        monitor_set_background(monitor, monitor->background_configured);
-
-        if(config->transition.duration && config->transition.func)
-            monitor->transition.config = config->transition;
-
         if(monitor->name)
             g_hash_table_insert(priv->monitors_map, g_strdup(monitor->name), monitor);
         g_hash_table_insert(priv->monitors_map, g_strdup_printf("%d", i), monitor);
     }
-    g_hash_table_unref(images_cache);
 
     if(priv->laptop_monitors && !priv->laptop_upower_proxy)
         greeter_background_try_init_dbus(background);
@@ -627,9 +944,31 @@ greeter_background_connect(GreeterBackground* background,
     if(!priv->active_monitor)
         greeter_background_set_active_monitor(background, NULL);
 
-    priv->screen_monitors_changed_handler_id = g_signal_connect(G_OBJECT(screen), "monitors-changed",
-                                                                G_CALLBACK(greeter_background_monitors_changed_cb),
-                                                                background);
+    greeter_background_start_loading(background);
+    greeter_background_schedule_sweep(background);
+    GREETER_TRACE_END("background_setup_monitors");
+}
+
+static Monitor*
+greeter_background_take_monitor(Monitor* old_monitors,
+                                gsize old_monitors_size,
+                                const Monitor* monitor)
+{
+    gsize i;
+
+    if(!monitor->name)
+        return NULL;
+
+    for(i = 0; i < old_monitors_size; ++i)
+    {
+        Monitor* old = &old_monitors[i];
+        if(old->window && old->config == monitor->config && old->scale == monitor->scale &&
+           g_strcmp0(old->name, monitor->name) == 0 &&
+           old->geometry.x == monitor->geometry.x && old->geometry.y == monitor->geometry.y &&
+           old->geometry.width == monitor->geometry.width && old->geometry.height == monitor->geometry.height)
+            return old;
+    }
+    return NULL;
 }
 
 void
@@ -907,9 +1246,19 @@ greeter_background_dbus_changed_cb(GDBusProxy* proxy,
         }
         else
         {
+            GSList* item;
+            for(item = priv->laptop_monitors; item; item = g_slist_next(item))
+            {
+                Monitor* monitor = item->data;
+                if(monitor->background && background_reload(monitor->background, background))
+                    monitor_set_background(monitor, monitor->background);
+            }
+            greeter_background_start_loading(background);
+
             if(!priv->follow_cursor)
                 greeter_background_set_active_monitor(background, NULL);
         }
+        greeter_background_schedule_residency(background);
     }
 }
 
@@ -918,7 +1267,31 @@ greeter_background_monitors_changed_cb(GdkScreen* screen,
                                        GreeterBackground* background)
 {
     g_return_if_fail(GREETER_IS_BACKGROUND(background));
-    greeter_background_connect(background, screen);
+    GreeterBackgroundPrivate* priv = background->priv;
+
+    g_debug("[Background] Monitors configuration changed");
+
+    Monitor* old_monitors = priv->monitors;
+    gsize old_monitors_size = priv->monitors_size;
+    const Monitor* old_active = priv->active_monitor;
+
+    g_hash_table_unref(priv->monitors_map);
+    g_slist_free(priv->customized_monitors);
+    g_slist_free(priv->laptop_monitors);
+    priv->monitors_map = NULL;
+    priv->customized_monitors = NULL;
+    priv->laptop_monitors = NULL;
+    priv->monitors = NULL;
+    priv->monitors_size = 0;
+    priv->active_monitor = NULL;
+
+    greeter_background_setup_monitors(background, old_monitors, old_monitors_size, old_active);
+
+    /* Removed and changed monitors, unchanged ones are moved to new array */
+    gsize i;
+    for(i = 0; i < old_monitors_size; ++i)
+        monitor_finalize(&old_monitors[i]);
+    g_free(old_monitors);
 }
 
 static void
@@ -928,170 +1301,591 @@ greeter_background_child_destroyed_cb(GtkWidget* child,
     background->priv->child = NULL;
 }
 
-void
-greeter_background_set_custom_background(GreeterBackground* background,
-                                         const gchar* value)
+static void
+greeter_background_queue_image(GreeterBackground* background,
+                               Background* bg,
+                               const gchar* path,
+                               ScalingMode mode,
+                               gint width, gint height)
 {
-    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    GreeterBackgroundPrivate* priv = background->priv;
+    BackgroundLoadTask* task = g_new0(BackgroundLoadTask, 1);
+
+    task->object = g_object_ref(background);
+    task->background = background_ref(bg);
+    task->path = g_strdup(path);
+    task->mode = mode;
+    task->width = width;
+    task->height = height;
+    task->cache_dir = g_strdup(priv->cache_dir);
+    task->queued = g_get_monotonic_time();
 
+    g_clear_object(&bg->cancellable);
+    bg->cancellable = g_cancellable_new();
+
+    priv->loader_queue = g_list_prepend(priv->loader_queue, task);
+}
+
+static void
+greeter_background_schedule_sweep(GreeterBackground* background)
+{
     GreeterBackgroundPrivate* priv = background->priv;
-    if(!priv->customized_monitors)
-        return;
 
-    BackgroundConfig config;
-    background_config_initialize(&config, value);
+    if(priv->backgrounds_sweep_id)
+        g_source_remove(priv->backgrounds_sweep_id);
+    priv->backgrounds_sweep_id = g_timeout_add_seconds(BACKGROUND_REGISTRY_TIMEOUT,
+                                                       (GSourceFunc)greeter_background_sweep_cb,
+                                                       background);
+}
 
-    GHashTable *images_cache = NULL;
-    if(config.type == BACKGROUND_TYPE_IMAGE)
-        images_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+/* Drop backgrounds referenced by registry only */
+static gboolean
+greeter_background_sweep_cb(GreeterBackground* background)
+{
+    GreeterBackgroundPrivate* priv = background->priv;
+    GHashTableIter iter;
+    gpointer value;
+    guint removed = 0;
 
-    GSList* iter;
-    for(iter = priv->customized_monitors; iter; iter = g_slist_next(iter))
-    {
-        Monitor *monitor = iter->data;
+    priv->backgrounds_sweep_id = 0;
 
-        /* Old background_custom (if used) will be unrefed in monitor_set_background() */
-        Background* bg = NULL;
-        if(config.type != BACKGROUND_TYPE_INVALID)
-            bg = background_new(&config, monitor, images_cache);
-        if(bg)
+    g_hash_table_iter_init(&iter, priv->backgrounds);
+    while(g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        const Background* bg = value;
+        if(bg->ref_count == 1)
         {
-            monitor_set_background(monitor, bg);
-            background_unref(&bg);
+            g_hash_table_iter_remove(&iter);
+            ++removed;
         }
-        else
-            monitor_set_background(monitor, monitor->background_configured);
     }
 
-    if(images_cache)
-        g_hash_table_unref(images_cache);
-    if(config.type != BACKGROUND_TYPE_INVALID)
-        background_config_finalize(&config);
+    g_debug("[Background] Unused backgrounds removed: %u, remaining: %u",
+            removed, g_hash_table_size(priv->backgrounds));
+    return G_SOURCE_REMOVE;
 }
 
-void
-greeter_background_save_xroot(GreeterBackground* background)
+/* Move user background to the head of custom_cache */
+static void
+greeter_background_cache_custom(GreeterBackground* background,
+                                Background* bg)
 {
-    g_return_if_fail(GREETER_IS_BACKGROUND(background));
-
     GreeterBackgroundPrivate* priv = background->priv;
-    cairo_surface_t* surface = create_root_surface(priv->screen);
-    cairo_t* cr = cairo_create(surface);
-    gsize i;
-    gdouble child_opacity;
 
-    const GdkRGBA ROOT_COLOR = {1.0, 1.0, 1.0, 1.0};
-    gdk_cairo_set_source_rgba(cr, &ROOT_COLOR);
-    cairo_paint(cr);
+    if(bg->type != BACKGROUND_TYPE_IMAGE)
+        return;
 
-    for(i = 0; i < priv->monitors_size; ++i)
+    GList* link = g_queue_find(priv->custom_cache, bg);
+    if(link)
     {
-        const Monitor* monitor = &priv->monitors[i];
-        if(!monitor->background)
-            continue;
+        g_queue_unlink(priv->custom_cache, link);
+        g_queue_push_head_link(priv->custom_cache, link);
+    }
+    else
+        g_queue_push_head(priv->custom_cache, background_ref(bg));
+}
 
-        #ifdef XROOT_DRAW_BACKGROUND_DIRECTLY
-        /* Old method: can't draw default GtkWindow background */
-        cairo_save(cr);
-        cairo_translate(cr, monitor->geometry.x, monitor->geometry.y);
-        monitor_draw_background(monitor, monitor->background, cr);
-        cairo_restore(cr);
-        #else
-        /* New - can draw anything, but looks tricky a bit */
-        child_opacity = gtk_widget_get_opacity(priv->child);
-        if(monitor == priv->active_monitor)
-        {
-            gtk_widget_set_opacity(priv->child, 0.0);
-            gdk_window_process_updates(gtk_widget_get_window(GTK_WIDGET(priv->child)), FALSE);
-        }
+/* Drop least recently used backgrounds until loaded images fit into custom_cache_limit */
+static void
+greeter_background_trim_custom_cache(GreeterBackground* background)
+{
+    GreeterBackgroundPrivate* priv = background->priv;
+    gsize total = 0;
+    guint removed = 0;
+    GList* item;
 
-        gdk_cairo_set_source_window(cr, gtk_widget_get_window(GTK_WIDGET(monitor->window)),
-                                    monitor->geometry.x, monitor->geometry.y);
-        cairo_paint(cr);
+    for(item = priv->custom_cache->head; item; item = item->next)
+        total += background_get_size(item->data);
 
-        if(monitor == priv->active_monitor)
-        {
-            gtk_widget_set_opacity(priv->child, child_opacity);
-            gdk_window_process_updates(gtk_widget_get_window(GTK_WIDGET(priv->child)), FALSE);
-        }
-        #endif
+    /* Displayed backgrounds are referenced by monitors too, so they stay alive */
+    while(total > priv->custom_cache_limit && priv->custom_cache->length > 1)
+    {
+        Background* bg = g_queue_pop_tail(priv->custom_cache);
+        total -= background_get_size(bg);
+        background_unref(&bg);
+        ++removed;
     }
-    set_surface_as_root(priv->screen, surface);
 
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
+    if(removed)
+    {
+        g_debug("[Background] User backgrounds removed from cache: %u, remaining: %u (%" G_GSIZE_FORMAT " bytes)",
+                removed, priv->custom_cache->length, total);
+        greeter_background_schedule_sweep(background);
+    }
 }
 
-const GdkRectangle*
-greeter_background_get_active_monitor_geometry(GreeterBackground* background)
+static void
+greeter_background_schedule_residency(GreeterBackground* background)
 {
-    g_return_if_fail(GREETER_IS_BACKGROUND(background));
     GreeterBackgroundPrivate* priv = background->priv;
+    if(!priv->residency_id)
+        priv->residency_id = g_idle_add_full(G_PRIORITY_LOW, (GSourceFunc)greeter_background_residency_cb,
+                                             background, NULL);
+}
 
-    return priv->active_monitor ? &priv->active_monitor->geometry : NULL;
+static gint
+background_compare_last_visible(const Background* a,
+                                const Background* b)
+{
+    return a->last_visible < b->last_visible ? -1 : a->last_visible > b->last_visible;
 }
 
-void
-greeter_background_add_accel_group(GreeterBackground* background,
-                                   GtkAccelGroup* group)
+/* Drop invisible images (e.g. configured backgrounds overridden by user background, disabled monitors).
+ * Recently used and prefetched user backgrounds are kept, they are dropped only to fit into memory_limit. */
+static gboolean
+greeter_background_residency_cb(GreeterBackground* background)
 {
-    g_return_if_fail(GREETER_IS_BACKGROUND(background));
-    g_return_if_fail(group != NULL);
     GreeterBackgroundPrivate* priv = background->priv;
+    GHashTableIter iter;
+    gpointer value;
+    GList* candidates = NULL;
+    GList* custom_candidates = NULL;
+    gsize total = 0;
+    guint resident = 0, evicted = 0;
+    gint64 now = g_get_monotonic_time();
 
-    if(priv->monitors)
+    priv->residency_id = 0;
+
+    /* Root pixmap thread reads images */
+    if(priv->xroot_thread)
+        return G_SOURCE_REMOVE;
+
+    g_hash_table_iter_init(&iter, priv->backgrounds);
+    while(g_hash_table_iter_next(&iter, NULL, &value))
     {
-        gint i;
-        for(i = 0; i < priv->monitors_size; ++i)
-            if(priv->monitors[i].window)
-                gtk_window_add_accel_group(priv->monitors[i].window, group);
+        Background* bg = value;
+        gsize size = background_get_size(bg);
+        if(!size)
+            continue;
+        total += size;
+        ++resident;
+        if(greeter_background_is_visible(background, bg))
+            bg->last_visible = now;
+        else if(g_queue_find(priv->custom_cache, bg))
+            custom_candidates = g_list_prepend(custom_candidates, bg);
+        else
+            candidates = g_list_prepend(candidates, bg);
     }
 
-    priv->accel_groups = g_slist_append(priv->accel_groups, group);
-}
+    GList* item;
+    for(item = candidates; item; item = g_list_next(item))
+    {
+        total -= background_get_size(item->data);
+        background_evict(item->data);
+        ++evicted;
+    }
+    g_list_free(candidates);
 
-static gboolean
-background_config_initialize(BackgroundConfig* config,
-                             const gchar* value)
-{
-    config->type = BACKGROUND_TYPE_INVALID;
-    if(!value || strlen(value) == 0)
-        return FALSE;
-    if(g_strcmp0(value, BACKGROUND_TYPE_SKIP_VALUE) == 0)
-        config->type = BACKGROUND_TYPE_SKIP;
-    else if(g_strcmp0(value, BACKGROUND_TYPE_DEFAULT_VALUE) == 0)
-        config->type = BACKGROUND_TYPE_DEFAULT;
-    else if(gdk_rgba_parse(&config->options.color, value))
-        config->type = BACKGROUND_TYPE_COLOR;
-    else
+    custom_candidates = g_list_sort(custom_candidates, (GCompareFunc)background_compare_last_visible);
+    for(item = custom_candidates; item && total > priv->memory_limit; item = g_list_next(item))
     {
-        const gchar** prefix = SCALING_MODE_PREFIXES;
-        while(*prefix && !g_str_has_prefix(value, *prefix))
-            ++prefix;
+        total -= background_get_size(item->data);
+        background_evict(item->data);
+        ++evicted;
+    }
+    g_list_free(custom_candidates);
 
-        if(*prefix)
-        {
-            config->options.image.mode = (ScalingMode)(prefix - SCALING_MODE_PREFIXES);
-            value += strlen(*prefix);
-        }
-        else
-            config->options.image.mode = SCALING_MODE_ZOOMED;
+    g_debug("[Background] Resident images: %u (%" G_GSIZE_FORMAT " bytes), evicted: %u",
+            resident - evicted, total, evicted);
 
-        config->options.image.path = g_strdup(value);
-        config->type = BACKGROUND_TYPE_IMAGE;
+    if(evicted || priv->residency_trim)
+    {
+        priv->residency_trim = FALSE;
+        #ifdef __GLIBC__
+        malloc_trim(0);
+        #endif
     }
-    return TRUE;
+
+    return G_SOURCE_REMOVE;
 }
 
-static void
-background_config_finalize(BackgroundConfig* config)
+/* TRUE if background is displayed by enabled monitor or used by transition.
+ * Transition of disabled monitor is still ticking and reads both images. */
+static gboolean
+greeter_background_is_visible(GreeterBackground* background,
+                              const Background* bg)
 {
-    switch(config->type)
+    GreeterBackgroundPrivate* priv = background->priv;
+    gsize i;
+
+    for(i = 0; i < priv->monitors_size; ++i)
     {
-        case BACKGROUND_TYPE_IMAGE:
-            g_free(config->options.image.path);
-            break;
-        case BACKGROUND_TYPE_COLOR:
+        const Monitor* monitor = &priv->monitors[i];
+        if(monitor->transition.from == bg || monitor->transition.to == bg)
+            return TRUE;
+        if(!monitor->background || !greeter_background_monitor_enabled(background, monitor))
+            continue;
+        if(monitor->background == bg || monitor->background_pending == bg)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* TRUE if image of background is waited for: by any monitor (enabled or not) or by last prefetch request */
+static gboolean
+greeter_background_is_wanted(GreeterBackground* background,
+                             const Background* bg)
+{
+    GreeterBackgroundPrivate* priv = background->priv;
+    gsize i;
+
+    if(g_slist_find(priv->prefetched, bg))
+        return TRUE;
+    for(i = 0; i < priv->monitors_size; ++i)
+    {
+        const Monitor* monitor = &priv->monitors[i];
+        if(monitor->background == bg || monitor->background_pending == bg ||
+           monitor->transition.from == bg || monitor->transition.to == bg)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Stop loading images nobody waits for (e.g. user background of previously selected user):
+ * worker blocked by slow file system is released, background is left evicted */
+static void
+greeter_background_cancel_loading(GreeterBackground* background)
+{
+    GreeterBackgroundPrivate* priv = background->priv;
+    GHashTableIter iter;
+    gpointer value;
+
+    g_hash_table_iter_init(&iter, priv->backgrounds);
+    while(g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        Background* bg = value;
+        if(!bg->cancellable || g_cancellable_is_cancelled(bg->cancellable) ||
+           greeter_background_is_wanted(background, bg))
+            continue;
+        g_debug("[Background] Cancelling loading of image: %s", bg->source.path);
+        g_cancellable_cancel(bg->cancellable);
+    }
+}
+
+/* Submit queued tasks to IO broker, image for active monitor goes first */
+static void
+greeter_background_start_loading(GreeterBackground* background)
+{
+    GreeterBackgroundPrivate* priv = background->priv;
+
+    if(!priv->loader_queue)
+        return;
+
+    GList* queue = g_list_reverse(priv->loader_queue);
+    priv->loader_queue = NULL;
+
+    g_debug("[Background] Loading %u image(s)", g_list_length(queue));
+
+    const Monitor* active = priv->active_monitor;
+    GList* iter;
+    gint pass;
+    for(pass = 0; pass < 2; ++pass)
+    {
+        for(iter = queue; iter; iter = g_list_next(iter))
+        {
+            BackgroundLoadTask* task = iter->data;
+            gboolean for_active = active && active->background_pending == task->background;
+            if(for_active != (pass == 0))
+                continue;
+            /* Task is read by worker after completion too: it is released by broker */
+            greeter_io_broker_submit(task->path, BACKGROUND_LOAD_TIMEOUT, task->background->cancellable,
+                                     (GreeterIOFunc)background_load_task_run,
+                                     task, (GDestroyNotify)background_load_task_free,
+                                     (GDestroyNotify)cairo_surface_destroy,
+                                     (GreeterIOCallback)background_load_task_finished_cb, task);
+        }
+    }
+    g_list_free(queue);
+}
+
+void
+greeter_background_set_custom_background(GreeterBackground* background,
+                                         const gchar* value)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+
+    GreeterBackgroundPrivate* priv = background->priv;
+    if(!priv->customized_monitors)
+        return;
+
+    greeter_background_discard_xroot(background);
+
+    BackgroundConfig config;
+    background_config_initialize(&config, value);
+
+    GSList* iter;
+    for(iter = priv->customized_monitors; iter; iter = g_slist_next(iter))
+    {
+        Monitor *monitor = iter->data;
+
+        /* Old background_custom (if used) will be unrefed in monitor_set_background() */
+        Background* bg = NULL;
+        if(config.type != BACKGROUND_TYPE_INVALID)
+            bg = background_new(&config, monitor);
+        if(bg)
+        {
+            greeter_background_cache_custom(background, bg);
+            monitor_set_background(monitor, bg);
+            background_unref(&bg);
+        }
+        else
+            monitor_set_background(monitor, monitor->background_configured);
+    }
+
+    if(config.type != BACKGROUND_TYPE_INVALID)
+        background_config_finalize(&config);
+
+    greeter_background_trim_custom_cache(background);
+    greeter_background_cancel_loading(background);
+    greeter_background_start_loading(background);
+    greeter_background_schedule_sweep(background);
+    greeter_background_schedule_residency(background);
+}
+
+/* Start loading of user backgrounds in background, they will be displayed instantly
+ * by greeter_background_set_custom_background(). Replaces previous request: loading
+ * of previously prefetched backgrounds that are not displayed is cancelled. */
+void
+greeter_background_prefetch_custom_backgrounds(GreeterBackground* background,
+                                               const gchar* const* values)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+
+    GreeterBackgroundPrivate* priv = background->priv;
+    if(!priv->customized_monitors)
+        return;
+
+    g_slist_free_full(priv->prefetched, (GDestroyNotify)background_release);
+    priv->prefetched = NULL;
+
+    for(; values && *values; ++values)
+    {
+        BackgroundConfig config;
+        if(!background_config_initialize(&config, *values))
+            continue;
+
+        if(config.type == BACKGROUND_TYPE_IMAGE)
+        {
+            GSList* iter;
+            for(iter = priv->customized_monitors; iter; iter = g_slist_next(iter))
+            {
+                Background* bg = background_new(&config, iter->data);
+                if(bg)
+                {
+                    greeter_background_cache_custom(background, bg);
+                    priv->prefetched = g_slist_prepend(priv->prefetched, bg);
+                }
+            }
+        }
+
+        background_config_finalize(&config);
+    }
+
+    greeter_background_trim_custom_cache(background);
+    greeter_background_cancel_loading(background);
+    greeter_background_start_loading(background);
+}
+
+/* TRUE if user background can be displayed without loading */
+gboolean
+greeter_background_is_custom_background_ready(GreeterBackground* background,
+                                              const gchar* value)
+{
+    g_return_val_if_fail(GREETER_IS_BACKGROUND(background), FALSE);
+
+    GreeterBackgroundPrivate* priv = background->priv;
+    BackgroundConfig config;
+    gboolean ready = TRUE;
+
+    if(!value || !background_config_initialize(&config, value))
+        return TRUE;
+
+    if(config.type == BACKGROUND_TYPE_IMAGE)
+    {
+        GSList* iter;
+        for(iter = priv->customized_monitors; iter && ready; iter = g_slist_next(iter))
+        {
+            gchar* key = background_get_key(&config, iter->data);
+            const Background* bg = g_hash_table_lookup(priv->backgrounds, key);
+            ready = bg && !bg->loading && !bg->evicted;
+            g_free(key);
+        }
+    }
+
+    background_config_finalize(&config);
+    return ready;
+}
+
+/* Start composing root pixmap from monitors backgrounds, can be called as soon as user is authenticated */
+void
+greeter_background_prepare_xroot(GreeterBackground* background)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+
+    GreeterBackgroundPrivate* priv = background->priv;
+    gsize i;
+
+    if(priv->xroot_thread || !priv->screen)
+        return;
+
+    XRootTask* task = g_new0(XRootTask, 1);
+    task->width = gdk_screen_get_width(priv->screen);
+    task->height = gdk_screen_get_height(priv->screen);
+    task->rects = g_new(GdkRectangle, priv->monitors_size);
+    task->colors = g_new(GdkRGBA, priv->monitors_size);
+    task->backgrounds = g_new0(Background*, priv->monitors_size);
+    task->sources = g_new0(XRootSource, priv->monitors_size);
+    task->cache_dir = g_strdup(priv->cache_dir);
+    task->image = cairo_image_surface_create(CAIRO_FORMAT_RGB24, task->width, task->height);
+    cairo_t* cr = cairo_create(task->image);
+
+    for(i = 0; i < priv->monitors_size; ++i)
+    {
+        const Monitor* monitor = &priv->monitors[i];
+        Background* bg = monitor->background;
+        if(!bg)
+            continue;
+        const Background* fallback = monitor->background_fallback;
+        task->rects[task->monitors_size] = monitor->geometry;
+        task->colors[task->monitors_size] = fallback && fallback->type == BACKGROUND_TYPE_COLOR
+                                          ? fallback->options.color : DEFAULT_MONITOR_CONFIG.bg.options.color;
+        if(bg->type == BACKGROUND_TYPE_DEFAULT)
+        {
+            /* GTK can not be used by thread */
+            GtkStyleContext* context = gtk_widget_get_style_context(GTK_WIDGET(monitor->window));
+            gtk_render_background(context, cr, monitor->geometry.x, monitor->geometry.y,
+                                  monitor->geometry.width, monitor->geometry.height);
+        }
+        if(bg->type == BACKGROUND_TYPE_IMAGE && !bg->options.image)
+        {
+            /* Image can be set by loader while thread is running: thread loads its own copy */
+            XRootSource* source = &task->sources[task->monitors_size];
+            source->path = g_strdup(bg->source.path);
+            source->mode = bg->source.mode;
+            source->width = bg->source.width;
+            source->height = bg->source.height;
+        }
+        else
+            task->backgrounds[task->monitors_size] = background_ref(bg);
+        task->monitors_size++;
+    }
+    cairo_destroy(cr);
+
+    g_debug("[Background] Composing root pixmap: %dx%d, monitors: %" G_GSIZE_FORMAT,
+            task->width, task->height, task->monitors_size);
+    priv->xroot_thread = g_thread_new("xroot", (GThreadFunc)xroot_task_run, task);
+}
+
+/* Drop root pixmap composed for outdated backgrounds */
+void
+greeter_background_discard_xroot(GreeterBackground* background)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+
+    GreeterBackgroundPrivate* priv = background->priv;
+    if(!priv->xroot_thread)
+        return;
+    xroot_task_free(g_thread_join(priv->xroot_thread));
+    priv->xroot_thread = NULL;
+}
+
+void
+greeter_background_save_xroot(GreeterBackground* background)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+
+    GreeterBackgroundPrivate* priv = background->priv;
+
+    greeter_background_prepare_xroot(background);
+    if(!priv->xroot_thread)
+        return;
+
+    gint64 started = g_get_monotonic_time();
+    XRootTask* task = g_thread_join(priv->xroot_thread);
+    priv->xroot_thread = NULL;
+    g_debug("[Background] Waited for root pixmap composing: %" G_GINT64_FORMAT " ms",
+            (g_get_monotonic_time() - started)/1000);
+
+    cairo_surface_t* surface = create_root_surface(priv->screen);
+    if(surface)
+    {
+        put_root_image(surface, task->image, task->rects, task->monitors_size);
+        set_surface_as_root(priv->screen, surface);
+        cairo_surface_destroy(surface);
+    }
+    xroot_task_free(task);
+}
+
+const GdkRectangle*
+greeter_background_get_active_monitor_geometry(GreeterBackground* background)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    GreeterBackgroundPrivate* priv = background->priv;
+
+    return priv->active_monitor ? &priv->active_monitor->geometry : NULL;
+}
+
+void
+greeter_background_add_accel_group(GreeterBackground* background,
+                                   GtkAccelGroup* group)
+{
+    g_return_if_fail(GREETER_IS_BACKGROUND(background));
+    g_return_if_fail(group != NULL);
+    GreeterBackgroundPrivate* priv = background->priv;
+
+    if(priv->monitors)
+    {
+        gint i;
+        for(i = 0; i < priv->monitors_size; ++i)
+            if(priv->monitors[i].window)
+                gtk_window_add_accel_group(priv->monitors[i].window, group);
+    }
+
+    priv->accel_groups = g_slist_append(priv->accel_groups, group);
+}
+
+static gboolean
+background_config_initialize(BackgroundConfig* config,
+                             const gchar* value)
+{
+    config->type = BACKGROUND_TYPE_INVALID;
+    if(!value || strlen(value) == 0)
+        return FALSE;
+    if(g_strcmp0(value, BACKGROUND_TYPE_SKIP_VALUE) == 0)
+        config->type = BACKGROUND_TYPE_SKIP;
+    else if(g_strcmp0(value, BACKGROUND_TYPE_DEFAULT_VALUE) == 0)
+        config->type = BACKGROUND_TYPE_DEFAULT;
+    else if(gdk_rgba_parse(&config->options.color, value))
+        config->type = BACKGROUND_TYPE_COLOR;
+    else
+    {
+        const gchar** prefix = SCALING_MODE_PREFIXES;
+        while(*prefix && !g_str_has_prefix(value, *prefix))
+            ++prefix;
+
+        if(*prefix)
+        {
+            config->options.image.mode = (ScalingMode)(prefix - SCALING_MODE_PREFIXES);
+            value += strlen(*prefix);
+        }
+        else
+            config->options.image.mode = SCALING_MODE_ZOOMED;
+
+        config->options.image.path = g_strdup(value);
+        config->type = BACKGROUND_TYPE_IMAGE;
+    }
+    return TRUE;
+}
+
+static void
+background_config_finalize(BackgroundConfig* config)
+{
+    switch(config->type)
+    {
+        case BACKGROUND_TYPE_IMAGE:
+            g_free(config->options.image.path);
+            break;
+        case BACKGROUND_TYPE_COLOR:
         case BACKGROUND_TYPE_DEFAULT:
         case BACKGROUND_TYPE_SKIP:
             break;
@@ -1141,86 +1935,419 @@ static MonitorConfig* monitor_config_copy(const MonitorConfig* source,
     return dest;
 }
 
-static Background*
-background_new(const BackgroundConfig* config,
-               const Monitor* monitor,
-               GHashTable* images_cache)
+static Background*
+background_new(const BackgroundConfig* config,
+               const Monitor* monitor)
+{
+    GreeterBackgroundPrivate* priv = monitor->object->priv;
+    Background bg = {0};
+
+    switch(config->type)
+    {
+        case BACKGROUND_TYPE_IMAGE:
+        {
+            Background* registered;
+            bg.key = background_get_key(config, monitor);
+            if(g_hash_table_lookup_extended(priv->backgrounds, bg.key, NULL, (gpointer*)&registered))
+            {
+                g_debug("[Background] Reusing loaded image: %s", config->options.image.path);
+                g_free(bg.key);
+                return background_ref(registered);
+            }
+            /* Image will be decoded by loader thread, see greeter_background_start_loading() */
+            bg.loading = TRUE;
+            bg.source.path = g_strdup(config->options.image.path);
+            bg.source.mode = config->options.image.mode;
+            bg.source.width = monitor->geometry.width;
+            bg.source.height = monitor->geometry.height;
+            break;
+        }
+        case BACKGROUND_TYPE_COLOR:
+            bg.options.color = config->options.color;
+            bg.opaque = bg.options.color.alpha >= 1.0;
+            break;
+        case BACKGROUND_TYPE_DEFAULT:
+            break;
+        case BACKGROUND_TYPE_SKIP:
+        case BACKGROUND_TYPE_INVALID:
+            g_return_val_if_reached(NULL);
+    }
+
+    bg.type = config->type;
+    bg.ref_count = 1;
+
+    Background* result = g_new(Background, 1);
+    *result = bg;
+
+    if(result->loading)
+    {
+        greeter_background_queue_image(monitor->object, result,
+                                       config->options.image.path, config->options.image.mode,
+                                       monitor->geometry.width, monitor->geometry.height);
+        g_hash_table_insert(priv->backgrounds, g_strdup(result->key), background_ref(result));
+    }
+
+    return result;
+}
+
+/* Drop decoded image, background_reload() loads it again (usually from disk cache) */
+static void
+background_evict(Background* bg)
+{
+    if(bg->type != BACKGROUND_TYPE_IMAGE || bg->loading || !bg->options.image)
+        return;
+
+    g_debug("[Background] Dropping invisible image: %s (%dx%d)", bg->source.path, bg->source.width, bg->source.height);
+    cairo_surface_destroy(bg->options.image);
+    bg->options.image = NULL;
+    if(bg->server_image)
+        cairo_surface_destroy(bg->server_image);
+    bg->server_image = NULL;
+    bg->evicted = TRUE;
+}
+
+/* Queue loading of evicted image, caller must start loader. Returns FALSE if image is not evicted. */
+static gboolean
+background_reload(Background* bg,
+                  GreeterBackground* background)
+{
+    if(!bg->evicted)
+        return FALSE;
+
+    g_debug("[Background] Reloading image: %s", bg->source.path);
+    bg->evicted = FALSE;
+    bg->loading = TRUE;
+    greeter_background_queue_image(background, bg, bg->source.path, bg->source.mode,
+                                   bg->source.width, bg->source.height);
+    return TRUE;
+}
+
+/* Memory used by decoded image */
+static gsize
+background_get_size(const Background* bg)
+{
+    if(bg->type != BACKGROUND_TYPE_IMAGE || !bg->options.image)
+        return 0;
+    return (gsize)cairo_image_surface_get_stride(bg->options.image)*cairo_image_surface_get_height(bg->options.image);
+}
+
+/* Upload image to X server once, drawing it later is a server-side composite.
+ * Returns NULL if server-side images are disabled or background has no image. */
+static cairo_surface_t*
+background_get_server_image(Background* bg,
+                            const Monitor* monitor)
+{
+    if(!monitor->object->priv->server_images || bg->type != BACKGROUND_TYPE_IMAGE || !bg->options.image)
+        return NULL;
+
+    if(!bg->server_image)
+    {
+        GdkWindow* window = gtk_widget_get_window(GTK_WIDGET(monitor->window));
+        if(!window)
+            return NULL;
+
+        cairo_surface_t* image = bg->options.image;
+        gint width = cairo_image_surface_get_width(image);
+        gint height = cairo_image_surface_get_height(image);
+
+        /* cairo-xlib uploads with XShm when server is local and with PutImage otherwise */
+        bg->server_image = gdk_window_create_similar_surface(window, cairo_surface_get_content(image), width, height);
+        cairo_t* cr = cairo_create(bg->server_image);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_surface(cr, image, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        g_debug("[Background] Image uploaded to X server: %dx%d", width, height);
+    }
+    return bg->server_image;
+}
+
+/* Draw area of background (monitor coordinates).
+ * Also used by root pixmap thread: must not touch GTK. */
+static void
+background_draw(const Background* bg,
+                const GdkRectangle* area,
+                cairo_t* cr)
+{
+    switch(bg->type)
+    {
+        case BACKGROUND_TYPE_IMAGE:
+            if(bg->options.image)
+            {
+                cairo_set_source_surface(cr, bg->options.image, 0, 0);
+                gdk_cairo_rectangle(cr, area);
+                cairo_fill(cr);
+            }
+            break;
+        case BACKGROUND_TYPE_COLOR:
+            gdk_cairo_rectangle(cr, area);
+            gdk_cairo_set_source_rgba(cr, &bg->options.color);
+            cairo_fill(cr);
+            break;
+        case BACKGROUND_TYPE_DEFAULT:
+            break;
+        case BACKGROUND_TYPE_SKIP:
+        case BACKGROUND_TYPE_INVALID:
+            g_return_if_reached();
+    }
+}
+
+static gchar*
+background_get_key(const BackgroundConfig* config,
+                   const Monitor* monitor)
+{
+    return g_strdup_printf("%s\n%d %dx%d@%d", config->options.image.path, config->options.image.mode,
+                           monitor->geometry.width, monitor->geometry.height, monitor->scale);
+}
+
+static Background*
+background_ref(Background* bg)
+{
+    bg->ref_count++;
+    return bg;
+}
+
+static void
+background_unref(Background** bg)
+{
+    if(!*bg)
+        return;
+    (*bg)->ref_count--;
+    if((*bg)->ref_count == 0)
+    {
+        background_finalize(*bg);
+        g_free((*bg)->key);
+        g_free((*bg)->source.path);
+        g_free(*bg);
+        *bg = NULL;
+    }
+}
+
+static void
+background_release(Background* bg)
+{
+    background_unref(&bg);
+}
+
+static void
+background_finalize(Background* bg)
+{
+    switch(bg->type)
+    {
+        case BACKGROUND_TYPE_IMAGE:
+            if(bg->options.image)
+                cairo_surface_destroy(bg->options.image);
+            bg->options.image = NULL;
+            if(bg->server_image)
+                cairo_surface_destroy(bg->server_image);
+            bg->server_image = NULL;
+            g_clear_object(&bg->cancellable);
+            break;
+        case BACKGROUND_TYPE_COLOR:
+        case BACKGROUND_TYPE_DEFAULT:
+            break;
+        case BACKGROUND_TYPE_SKIP:
+        case BACKGROUND_TYPE_INVALID:
+            g_return_if_reached();
+    }
+
+    bg->type = BACKGROUND_TYPE_INVALID;
+}
+
+static gpointer
+background_load_task_run(const gchar* path,
+                         BackgroundLoadTask* task,
+                         GError** error)
+{
+    GREETER_TRACE_BEGIN("background_load");
+    cairo_surface_t* image = scale_image_file(path, task->mode, task->width, task->height, task->cache_dir);
+    GREETER_TRACE_END("background_load");
+    return image;
+}
+
+static void
+background_load_task_finished_cb(const gchar* path,
+                                 cairo_surface_t* image,
+                                 const GError* error,
+                                 BackgroundLoadTask* task)
+{
+    GreeterBackgroundPrivate* priv = task->object->priv;
+    Background* bg = task->background;
+    gboolean failed = image == NULL;
+
+    bg->loading = FALSE;
+    g_clear_object(&bg->cancellable);
+
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+        /* Loaded again on next use, see background_reload() */
+        bg->evicted = TRUE;
+        /* Image was requested again while cancellation was in progress */
+        if(greeter_background_is_wanted(task->object, bg))
+        {
+            background_reload(bg, task->object);
+            greeter_background_start_loading(task->object);
+        }
+        return;
+    }
+
+    if(failed)
+    {
+        g_warning("[Background] Failed to read wallpaper: %s", error ? error->message : path);
+        /* Do not share broken background, next request will try to load it again */
+        if(bg->key && g_hash_table_lookup(priv->backgrounds, bg->key) == bg)
+            g_hash_table_remove(priv->backgrounds, bg->key);
+        bg->type = BACKGROUND_TYPE_COLOR;
+        bg->options.color = DEFAULT_MONITOR_CONFIG.bg.options.color;
+        bg->opaque = bg->options.color.alpha >= 1.0;
+    }
+    else
+    {
+        bg->options.image = image;
+        bg->opaque = cairo_image_surface_get_format(bg->options.image) == CAIRO_FORMAT_RGB24;
+        g_debug("[Background] Image loaded in %" G_GINT64_FORMAT " ms: %s (%dx%d), %s",
+                (g_get_monotonic_time() - task->queued)/1000, task->path, task->width, task->height,
+                bg->opaque ? "opaque: painted as copy (SOURCE)" : "with alpha: painted with blending (OVER)");
+    }
+
+    gint i;
+    for(i = 0; i < priv->monitors_size; ++i)
+    {
+        Monitor* monitor = &priv->monitors[i];
+        if(monitor->background_pending != bg)
+            continue;
+        /* Failed user background: return to configured one */
+        if(failed && monitor->background_configured != bg)
+            monitor_set_background(monitor, monitor->background_configured);
+        else
+        {
+            gboolean reloaded = monitor->background == bg;
+            monitor_set_background(monitor, bg);
+            if(reloaded)
+                gtk_widget_queue_draw(GTK_WIDGET(monitor->window));
+        }
+    }
+
+    /* Decoder scratch memory is freed by now */
+    priv->residency_trim = TRUE;
+    greeter_background_schedule_residency(task->object);
+
+    if(!failed && g_queue_find(priv->custom_cache, bg))
+        greeter_background_trim_custom_cache(task->object);
+}
+
+/* Called in IO broker thread */
+static gpointer
+background_trim_disk_cache(const gchar* cache_dir,
+                           gpointer limit,
+                           GError** error)
+{
+    GREETER_TRACE_BEGIN("image_cache_trim");
+    greeter_image_cache_trim(cache_dir, GPOINTER_TO_SIZE(limit));
+    GREETER_TRACE_END("image_cache_trim");
+    return NULL;
+}
+
+static gpointer
+xroot_task_run(XRootTask* task)
 {
-    Background bg = {0};
+    gsize i;
 
-    switch(config->type)
+    GREETER_TRACE_BEGIN("xroot_compose");
+    cairo_t* cr = cairo_create(task->image);
+
+    for(i = 0; i < task->monitors_size; ++i)
     {
-        case BACKGROUND_TYPE_IMAGE:
-            bg.options.image = scale_image_file(config->options.image.path, config->options.image.mode,
-                                                monitor->geometry.width, monitor->geometry.height,
-                                                images_cache);
-            if(!bg.options.image)
+        const GdkRectangle* rect = &task->rects[i];
+        cairo_save(cr);
+        cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
+        cairo_clip(cr);
+        cairo_translate(cr, rect->x, rect->y);
+        GdkRectangle area = {0, 0, rect->width, rect->height};
+        /* Default background is already rendered */
+        if(!task->backgrounds[i] || task->backgrounds[i]->type != BACKGROUND_TYPE_DEFAULT)
+        {
+            gdk_cairo_set_source_rgba(cr, &task->colors[i]);
+            cairo_paint(cr);
+        }
+        if(task->backgrounds[i])
+            background_draw(task->backgrounds[i], &area, cr);
+        else
+        {
+            const XRootSource* source = &task->sources[i];
+            cairo_surface_t* image = scale_image_file(source->path, source->mode,
+                                                      source->width, source->height, task->cache_dir);
+            if(image)
             {
-                g_warning("[Background] Failed to read wallpaper: %s", config->options.image.path);
-                return NULL;
+                cairo_set_source_surface(cr, image, 0, 0);
+                gdk_cairo_rectangle(cr, &area);
+                cairo_fill(cr);
+                cairo_surface_destroy(image);
             }
-            break;
-        case BACKGROUND_TYPE_COLOR:
-            bg.options.color = config->options.color;
-            break;
-        case BACKGROUND_TYPE_DEFAULT:
-            break;
-        case BACKGROUND_TYPE_SKIP:
-        case BACKGROUND_TYPE_INVALID:
-            g_return_val_if_reached(NULL);
+        }
+        cairo_restore(cr);
     }
 
-    bg.type = config->type;
-    bg.ref_count = 1;
-
-    Background* result = g_new(Background, 1);
-    *result = bg;
-    return result;
-}
-
-static Background*
-background_ref(Background* bg)
-{
-    bg->ref_count++;
-    return bg;
+    cairo_destroy(cr);
+    cairo_surface_flush(task->image);
+    GREETER_TRACE_END("xroot_compose");
+    return task;
 }
 
 static void
-background_unref(Background** bg)
+xroot_task_free(XRootTask* task)
 {
-    if(!*bg)
-        return;
-    (*bg)->ref_count--;
-    if((*bg)->ref_count == 0)
+    gsize i;
+    for(i = 0; i < task->monitors_size; ++i)
     {
-        background_finalize(*bg);
-        *bg = NULL;
+        background_unref(&task->backgrounds[i]);
+        g_free(task->sources[i].path);
     }
+    if(task->image)
+        cairo_surface_destroy(task->image);
+    g_free(task->cache_dir);
+    g_free(task->sources);
+    g_free(task->backgrounds);
+    g_free(task->colors);
+    g_free(task->rects);
+    g_free(task);
 }
 
 static void
-background_finalize(Background* bg)
+background_load_task_free(BackgroundLoadTask* task)
 {
-    switch(bg->type)
-    {
-        case BACKGROUND_TYPE_IMAGE:
-            g_clear_object(&bg->options.image);
-            break;
-        case BACKGROUND_TYPE_COLOR:
-        case BACKGROUND_TYPE_DEFAULT:
-            break;
-        case BACKGROUND_TYPE_SKIP:
-        case BACKGROUND_TYPE_INVALID:
-            g_return_if_reached();
-    }
-
-    bg->type = BACKGROUND_TYPE_INVALID;
+    background_unref(&task->background);
+    g_clear_object(&task->object);
+    g_free(task->cache_dir);
+    g_free(task->path);
+    g_free(task);
 }
 
 static void
 monitor_set_background(Monitor* monitor,
                        Background* background)
 {
+    if(background_reload(background, monitor->object))
+        greeter_background_start_loading(monitor->object);
+
+    if(background->loading)
+    {
+        /* Keep current background until image is loaded */
+        if(monitor->background_pending != background)
+        {
+            background_unref(&monitor->background_pending);
+            monitor->background_pending = background_ref(background);
+        }
+        return;
+    }
+
+    if(monitor->background_pending)
+    {
+        background_unref(&monitor->background_pending);
+        monitor->background_pending = NULL;
+    }
+
     if(monitor->background == background)
         return;
     monitor_stop_transition(monitor);
@@ -1245,6 +2372,8 @@ monitor_set_background(Monitor* monitor,
     background_unref(&monitor->background);
     monitor->background = background_ref(background);
     gtk_widget_queue_draw(GTK_WIDGET(monitor->window));
+
+    greeter_background_schedule_residency(monitor->object);
 }
 
 static void
@@ -1263,6 +2392,13 @@ monitor_start_transition(Monitor* monitor,
                                                                 monitor,
                                                                 NULL);
     monitor->transition.stage = 0;
+    monitor->transition.frames = 0;
+    monitor->transition.pixels = 0;
+
+    /* Client-side blending sends whole frame to X server, server-side images are composited by XRender */
+    if(monitor->transition.config.draw == (TransitionDraw)monitor_transition_draw_alpha &&
+       !monitor->object->priv->server_images)
+        monitor_transition_prepare_blend(monitor);
 }
 
 static void
@@ -1271,11 +2407,22 @@ monitor_stop_transition(Monitor* monitor)
     if(!monitor->transition.timer_id)
         return;
     gtk_widget_remove_tick_callback(GTK_WIDGET(monitor->window), monitor->transition.timer_id);
+    g_debug("[Background] Transition of monitor %s #%d: %u frame(s) in %" G_GINT64_FORMAT " ms, %" G_GUINT64_FORMAT " pixels repainted",
+            monitor->name, monitor->number, monitor->transition.frames,
+            (g_get_monotonic_time() - monitor->transition.started)/1000, monitor->transition.pixels);
     monitor->transition.timer_id = 0;
     monitor->transition.started = 0;
     monitor->transition.stage = 0;
     background_unref(&monitor->transition.to);
     background_unref(&monitor->transition.from);
+
+    if(monitor->transition.surface)
+        cairo_surface_destroy(monitor->transition.surface);
+    monitor->transition.surface = NULL;
+    g_free(monitor->transition.from_row);
+    g_free(monitor->transition.to_row);
+    monitor->transition.from_row = NULL;
+    monitor->transition.to_row = NULL;
 }
 
 static gboolean
@@ -1291,7 +2438,13 @@ monitor_transition_cb(GtkWidget *widget,
     monitor->transition.stage = monitor->transition.config.func(x);
 
     if(x >= 1.0)
+    {
         monitor_stop_transition(monitor);
+        /* Images of disabled monitor were kept only for transition */
+        greeter_background_schedule_residency(monitor->object);
+    }
+    else if(monitor->transition.surface)
+        monitor_transition_blend(monitor);
 
     gtk_widget_queue_draw(GTK_WIDGET(monitor->window));
     return x >= 1.0 ? G_SOURCE_REMOVE : G_SOURCE_CONTINUE;
@@ -1301,8 +2454,28 @@ static void
 monitor_transition_draw_alpha(const Monitor* monitor,
                               cairo_t* cr)
 {
+    /* Fast path: frame is already blended by monitor_transition_blend() */
+    if(monitor->transition.surface)
+    {
+        cairo_set_source_surface(cr, monitor->transition.surface, 0, 0);
+        if(cairo_image_surface_get_format(monitor->transition.surface) == CAIRO_FORMAT_RGB24)
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        monitor_add_dirty_area(monitor, cr, NULL);
+        cairo_fill(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        return;
+    }
+
     monitor_draw_background(monitor, monitor->transition.from, cr);
 
+    /* Opaque pair: "to" can be painted with constant alpha directly, no intermediate group */
+    if(monitor->transition.from->opaque && monitor->transition.to->opaque)
+    {
+        if(monitor_set_background_source(monitor, monitor->transition.to, cr))
+            cairo_paint_with_alpha(cr, monitor->transition.stage);
+        return;
+    }
+
     cairo_push_group(cr);
     monitor_draw_background(monitor, monitor->transition.to, cr);
     cairo_pop_group_to_source(cr);
@@ -1312,6 +2485,119 @@ monitor_transition_draw_alpha(const Monitor* monitor,
     cairo_pattern_destroy(alpha_pattern);
 }
 
+/* Source for direct crossfade: image surface of monitor size or solid color row.
+ * Returns FALSE if background can not be used for direct crossfade. */
+static gboolean
+background_get_blend_source(const Background* bg,
+                            const Monitor* monitor,
+                            cairo_format_t* format,
+                            cairo_surface_t** surface,
+                            guint32** row)
+{
+    *surface = NULL;
+    *row = NULL;
+
+    if(bg->type == BACKGROUND_TYPE_IMAGE)
+    {
+        cairo_surface_t* image = bg->options.image;
+        if(!image || cairo_surface_get_type(image) != CAIRO_SURFACE_TYPE_IMAGE ||
+           cairo_image_surface_get_width(image) != monitor->geometry.width ||
+           cairo_image_surface_get_height(image) != monitor->geometry.height)
+            return FALSE;
+        *format = cairo_image_surface_get_format(image);
+        if(*format != CAIRO_FORMAT_ARGB32 && *format != CAIRO_FORMAT_RGB24)
+            return FALSE;
+        *surface = image;
+        return TRUE;
+    }
+    else if(bg->type == BACKGROUND_TYPE_COLOR)
+    {
+        const GdkRGBA* color = &bg->options.color;
+        guint32 alpha = (guint32)(CLAMP(color->alpha, 0.0, 1.0)*255.0 + 0.5);
+        guint32 pixel = (alpha << 24) |
+                        ((guint32)(CLAMP(color->red, 0.0, 1.0)*alpha + 0.5) << 16) |
+                        ((guint32)(CLAMP(color->green, 0.0, 1.0)*alpha + 0.5) << 8) |
+                        (guint32)(CLAMP(color->blue, 0.0, 1.0)*alpha + 0.5);
+        gint i;
+        *format = alpha == 0xff ? CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32;
+        *row = g_new(guint32, monitor->geometry.width);
+        for(i = 0; i < monitor->geometry.width; ++i)
+            (*row)[i] = pixel;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+monitor_transition_prepare_blend(Monitor* monitor)
+{
+    cairo_format_t from_format, to_format;
+    cairo_surface_t* from_surface;
+    cairo_surface_t* to_surface;
+
+    if(!background_get_blend_source(monitor->transition.from, monitor, &from_format,
+                                    &from_surface, &monitor->transition.from_row) ||
+       !background_get_blend_source(monitor->transition.to, monitor, &to_format,
+                                    &to_surface, &monitor->transition.to_row) ||
+       /* RGB24 does not define alpha byte, it can not be mixed with ARGB32 */
+       (from_format != to_format && (from_surface || to_surface)))
+    {
+        g_free(monitor->transition.from_row);
+        g_free(monitor->transition.to_row);
+        monitor->transition.from_row = NULL;
+        monitor->transition.to_row = NULL;
+        return;
+    }
+
+    monitor->transition.surface = cairo_image_surface_create(from_format == to_format ? from_format : CAIRO_FORMAT_ARGB32,
+                                                             monitor->geometry.width, monitor->geometry.height);
+    if(cairo_surface_status(monitor->transition.surface) != CAIRO_STATUS_SUCCESS)
+    {
+        cairo_surface_destroy(monitor->transition.surface);
+        monitor->transition.surface = NULL;
+        return;
+    }
+
+    g_debug("[Background] Monitor %s #%d: using %s crossfade", monitor->name, monitor->number,
+            greeter_blend_get_implementation());
+    monitor_transition_blend(monitor);
+}
+
+static void
+monitor_transition_blend(Monitor* monitor)
+{
+    cairo_surface_t* from_surface = monitor->transition.from_row ? NULL : monitor->transition.from->options.image;
+    cairo_surface_t* to_surface = monitor->transition.to_row ? NULL : monitor->transition.to->options.image;
+    cairo_surface_t* dest = monitor->transition.surface;
+    guint weight = (guint)(CLAMP(monitor->transition.stage, 0.0, 1.0)*GREETER_BLEND_WEIGHT_MAX + 0.5);
+    gint y;
+
+    cairo_surface_flush(dest);
+    if(from_surface)
+        cairo_surface_flush(from_surface);
+    if(to_surface)
+        cairo_surface_flush(to_surface);
+
+    guchar* dest_data = cairo_image_surface_get_data(dest);
+    gint dest_stride = cairo_image_surface_get_stride(dest);
+
+    for(y = 0; y < monitor->geometry.height; ++y)
+    {
+        const guint32* from_row = from_surface
+                                ? (const guint32*)(cairo_image_surface_get_data(from_surface) +
+                                                   y*cairo_image_surface_get_stride(from_surface))
+                                : monitor->transition.from_row;
+        const guint32* to_row = to_surface
+                              ? (const guint32*)(cairo_image_surface_get_data(to_surface) +
+                                                 y*cairo_image_surface_get_stride(to_surface))
+                              : monitor->transition.to_row;
+        greeter_blend_crossfade_row((guint32*)(dest_data + y*dest_stride), from_row, to_row,
+                                    monitor->geometry.width, weight);
+    }
+
+    cairo_surface_mark_dirty(dest);
+}
+
 static void
 monitor_finalize(Monitor* monitor)
 {
@@ -1327,6 +2613,8 @@ monitor_finalize(Monitor* monitor)
         g_signal_handler_disconnect(monitor->window, monitor->window_draw_handler_id);
 
     background_unref(&monitor->background_configured);
+    background_unref(&monitor->background_fallback);
+    background_unref(&monitor->background_pending);
     background_unref(&monitor->background);
 
     if(monitor->window)
@@ -1342,48 +2630,168 @@ monitor_finalize(Monitor* monitor)
     *monitor = INVALID_MONITOR_STRUCT;
 }
 
+/* Move monitor to new location, rebinding its window signals */
+static void
+monitor_move(Monitor* dest,
+             Monitor* source)
+{
+    /* Name can be already filled by greeter_background_setup_monitors(), source has the same one */
+    g_free(dest->name);
+    *dest = *source;
+    *source = INVALID_MONITOR_STRUCT;
+
+    g_signal_handler_disconnect(dest->window, dest->window_draw_handler_id);
+    dest->window_draw_handler_id = g_signal_connect(G_OBJECT(dest->window), "draw",
+                                                    G_CALLBACK(monitor_window_draw_cb),
+                                                    dest);
+
+    if(g_signal_handlers_disconnect_by_func(dest->window, monitor_window_enter_notify_cb, source))
+        g_signal_connect(G_OBJECT(dest->window), "enter-notify-event",
+                         G_CALLBACK(monitor_window_enter_notify_cb), dest);
+
+    if(dest->transition.timer_id)
+    {
+        gtk_widget_remove_tick_callback(GTK_WIDGET(dest->window), dest->transition.timer_id);
+        dest->transition.timer_id = gtk_widget_add_tick_callback(GTK_WIDGET(dest->window),
+                                                                 (GtkTickCallback)monitor_transition_cb,
+                                                                 dest,
+                                                                 NULL);
+    }
+}
+
 static void
 monitor_draw_background(const Monitor* monitor,
-                        const Background* background,
+                        Background* background,
                         cairo_t* cr)
 {
     g_return_if_fail(monitor != NULL);
     g_return_if_fail(background != NULL);
 
+    if(!monitor_set_background_source(monitor, background, cr))
+        return;
+
+    /* Opaque: plain copy, no per-pixel alpha blending */
+    if(background->opaque)
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    monitor_add_dirty_area(monitor, cr, NULL);
+    cairo_fill(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+}
+
+/* Returns FALSE if there is nothing to draw (default background or image is not loaded) */
+static gboolean
+monitor_set_background_source(const Monitor* monitor,
+                              Background* background,
+                              cairo_t* cr)
+{
+    cairo_surface_t* server_image = background_get_server_image(background, monitor);
+    if(server_image)
+    {
+        cairo_set_source_surface(cr, server_image, 0, 0);
+        return TRUE;
+    }
+
     switch(background->type)
     {
         case BACKGROUND_TYPE_IMAGE:
-            if(background->options.image)
-            {
-                gdk_cairo_set_source_pixbuf(cr, background->options.image, 0, 0);
-                cairo_paint(cr);
-            }
-            break;
+            if(!background->options.image)
+                return FALSE;
+            cairo_set_source_surface(cr, background->options.image, 0, 0);
+            return TRUE;
         case BACKGROUND_TYPE_COLOR:
-            cairo_rectangle(cr, 0, 0, monitor->geometry.width, monitor->geometry.height);
             gdk_cairo_set_source_rgba(cr, &background->options.color);
-            cairo_fill(cr);
-            break;
-        case BACKGROUND_TYPE_DEFAULT:
-            break;
-        case BACKGROUND_TYPE_SKIP:
-        case BACKGROUND_TYPE_INVALID:
-            g_return_if_reached();
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+/* Add parts of monitor window that must be repainted to current path: clip is set by GTK
+ * to damaged region. Damaged rectangles are added separately, not as their bounding box.
+ * Returns number of pixels. */
+static guint64
+monitor_add_dirty_area(const Monitor* monitor,
+                       cairo_t* cr,
+                       guint* rects_count)
+{
+    cairo_rectangle_list_t* list = cairo_copy_clip_rectangle_list(cr);
+    guint64 pixels = 0;
+    gint i;
+
+    if(list->status == CAIRO_STATUS_SUCCESS)
+    {
+        for(i = 0; i < list->num_rectangles; ++i)
+        {
+            const cairo_rectangle_t* rect = &list->rectangles[i];
+            pixels += monitor_add_dirty_rect(monitor, cr, rect->x, rect->y,
+                                             rect->x + rect->width, rect->y + rect->height);
+        }
+        if(rects_count)
+            *rects_count = list->num_rectangles;
+    }
+    else
+    {
+        /* Clip can not be represented by rectangles */
+        gdouble x1, y1, x2, y2;
+        cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+        pixels = monitor_add_dirty_rect(monitor, cr, x1, y1, x2, y2);
+        if(rects_count)
+            *rects_count = 1;
     }
+
+    cairo_rectangle_list_destroy(list);
+    return pixels;
+}
+
+static guint64
+monitor_add_dirty_rect(const Monitor* monitor,
+                       cairo_t* cr,
+                       gdouble x1, gdouble y1,
+                       gdouble x2, gdouble y2)
+{
+    gint x = CLAMP((gint)floor(x1), 0, monitor->geometry.width);
+    gint y = CLAMP((gint)floor(y1), 0, monitor->geometry.height);
+    gint width = CLAMP((gint)ceil(x2), 0, monitor->geometry.width) - x;
+    gint height = CLAMP((gint)ceil(y2), 0, monitor->geometry.height) - y;
+
+    if(width <= 0 || height <= 0)
+        return 0;
+    cairo_rectangle(cr, x, y, width, height);
+    return (guint64)width*height;
 }
 
 static gboolean
 monitor_window_draw_cb(GtkWidget* widget,
                        cairo_t* cr,
-                       const Monitor* monitor)
+                       Monitor* monitor)
 {
     if(!monitor->background)
         return FALSE;
 
+    GreeterBackgroundPrivate* priv = monitor->object->priv;
+    guint rects_count = 0;
+    /* Statistics only */
+    guint64 pixels = monitor_add_dirty_area(monitor, cr, &rects_count);
+    cairo_new_path(cr);
+    priv->repaints_count++;
+    priv->repainted_pixels += pixels;
+
     if(monitor->transition.started)
+    {
+        /* One frame per refresh: summary is logged by monitor_stop_transition() */
+        monitor->transition.frames++;
+        monitor->transition.pixels += pixels;
         monitor->transition.config.draw(monitor, cr);
+    }
     else
+    {
+        g_debug("[Background] Repaint #%u of monitor %s #%d: %u rectangle(s), %" G_GUINT64_FORMAT " pixels (%.1f%% of monitor, %s), total pixels: %" G_GUINT64_FORMAT,
+                priv->repaints_count, monitor->name, monitor->number, rects_count, pixels,
+                100.0*pixels/MAX(1, monitor->geometry.width*monitor->geometry.height),
+                monitor->background->opaque ? "opaque copy" : "alpha blending",
+                priv->repainted_pixels);
         monitor_draw_background(monitor, monitor->background, cr);
+    }
 
     return FALSE;
 }
@@ -1399,52 +2807,147 @@ monitor_window_enter_notify_cb(GtkWidget* widget,
     return FALSE;
 }
 
-static GdkPixbuf*
+/* Can be called from loader thread: do not touch anything except arguments */
+static cairo_surface_t*
 scale_image_file(const gchar* path,
                  ScalingMode mode,
                  gint width, gint height,
-                 GHashTable* cache)
+                 const gchar* cache_dir)
 {
-    gchar* key = NULL;
-    GdkPixbuf* pixbuf = NULL;
+    cairo_surface_t* surface = NULL;
 
-    if(cache)
+    if(cache_dir)
     {
-        key = g_strdup_printf("%s\n%d %dx%d", path, mode, width, height);
-        if(g_hash_table_lookup_extended(cache, key, NULL, (gpointer*)&pixbuf))
+        GREETER_TRACE_BEGIN("image_cache_lookup");
+        surface = greeter_image_cache_lookup(cache_dir, path, mode, width, height);
+        GREETER_TRACE_END("image_cache_lookup");
+        if(surface)
         {
-            g_free(key);
-            return GDK_PIXBUF(g_object_ref(pixbuf));
+            g_debug("[Background] Using cached image: %s (%dx%d)", path, width, height);
+            return surface;
         }
     }
 
-    if(!cache || !g_hash_table_lookup_extended(cache, path, NULL, (gpointer*)&pixbuf))
+    GError *error = NULL;
+    GREETER_TRACE_BEGIN("image_decode");
+    GdkPixbuf* pixbuf = load_image_file(path, mode, width, height, &error);
+    GREETER_TRACE_END("image_decode");
+    if(error)
     {
-        GError *error = NULL;
-        pixbuf = gdk_pixbuf_new_from_file(path, &error);
-        if(error)
-        {
-            g_warning("[Background] Failed to load background: %s", error->message);
-            g_clear_error(&error);
-        }
-        else if(cache)
-            g_hash_table_insert(cache, g_strdup(path), g_object_ref(pixbuf));
+        g_warning("[Background] Failed to load background: %s", error->message);
+        g_clear_error(&error);
     }
-    else
-        pixbuf = g_object_ref(pixbuf);
 
+    GdkPixbuf* scaled = NULL;
     if(pixbuf)
     {
-        GdkPixbuf* scaled = scale_image(pixbuf, mode, width, height);
-        if(cache)
-            g_hash_table_insert(cache, g_strdup(key), g_object_ref(scaled));
+        GREETER_TRACE_BEGIN("image_scale");
+        scaled = scale_image(pixbuf, mode, width, height);
+        GREETER_TRACE_END("image_scale");
         g_object_unref(pixbuf);
-        pixbuf = scaled;
     }
 
-    g_free(key);
+    if(scaled)
+    {
+        /* Convert once to premultiplied cairo format, every redraw is a plain blit */
+        surface = gdk_cairo_surface_create_from_pixbuf(scaled, 1, NULL);
+        g_object_unref(scaled);
+        surface = image_surface_drop_alpha(surface);
 
-    return pixbuf;
+        if(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        {
+            g_warning("[Background] Failed to create image surface: %s",
+                      cairo_status_to_string(cairo_surface_status(surface)));
+            cairo_surface_destroy(surface);
+            surface = NULL;
+        }
+        else if(cache_dir)
+        {
+            GREETER_TRACE_BEGIN("image_cache_store");
+            greeter_image_cache_store(cache_dir, path, mode, width, height, surface);
+            GREETER_TRACE_END("image_cache_store");
+        }
+    }
+
+    return surface;
+}
+
+/* Decode image at the smallest size that still covers width x height.
+ * Loaders can use it to skip most of decoding work (e.g. DCT scaling for JPEG),
+ * final exact scaling is done by scale_image(). */
+static GdkPixbuf*
+load_image_file(const gchar* path,
+                ScalingMode mode,
+                gint width, gint height,
+                GError** error)
+{
+    gint p_width, p_height;
+
+    if(mode == SCALING_MODE_SOURCE || !gdk_pixbuf_get_file_info(path, &p_width, &p_height) ||
+       p_width <= 0 || p_height <= 0 || width <= 0 || height <= 0)
+        return gdk_pixbuf_new_from_file(path, error);
+
+    gint load_width = p_width;
+    gint load_height = p_height;
+
+    if(mode == SCALING_MODE_ZOOMED)
+    {
+        gdouble scale = MAX((gdouble)width/p_width, (gdouble)height/p_height);
+        if(scale < 1.0)
+        {
+            load_width = MAX(width, (gint)ceil(p_width*scale));
+            load_height = MAX(height, (gint)ceil(p_height*scale));
+        }
+    }
+    else if(mode == SCALING_MODE_STRETCHED)
+    {
+        load_width = MIN(width, p_width);
+        load_height = MIN(height, p_height);
+    }
+
+    if(load_width == p_width && load_height == p_height)
+        return gdk_pixbuf_new_from_file(path, error);
+
+    g_debug("[Background] Decoding %s at %dx%d instead of %dx%d", path, load_width, load_height, p_width, p_height);
+    return gdk_pixbuf_new_from_file_at_scale(path, load_width, load_height, FALSE, error);
+}
+
+/* Convert ARGB32 image without transparent pixels to RGB24, takes ownership of surface */
+static cairo_surface_t*
+image_surface_drop_alpha(cairo_surface_t* surface)
+{
+    if(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS ||
+       cairo_image_surface_get_format(surface) != CAIRO_FORMAT_ARGB32)
+        return surface;
+
+    gint width = cairo_image_surface_get_width(surface);
+    gint height = cairo_image_surface_get_height(surface);
+    gint stride = cairo_image_surface_get_stride(surface);
+    const guchar* data = cairo_image_surface_get_data(surface);
+    gint x, y;
+
+    cairo_surface_flush(surface);
+    for(y = 0; y < height; ++y)
+    {
+        const guint32* row = (const guint32*)(data + (gsize)y*stride);
+        for(x = 0; x < width; ++x)
+            if((row[x] >> 24) != 0xFF)
+                return surface;
+    }
+
+    cairo_surface_t* opaque = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+    if(cairo_surface_status(opaque) != CAIRO_STATUS_SUCCESS ||
+       cairo_image_surface_get_stride(opaque) != stride)
+    {
+        cairo_surface_destroy(opaque);
+        return surface;
+    }
+    memcpy(cairo_image_surface_get_data(opaque), data, (gsize)stride*height);
+    cairo_surface_mark_dirty(opaque);
+    cairo_surface_destroy(surface);
+
+    g_debug("[Background] Image has no transparent pixels, using RGB24 format");
+    return opaque;
 }
 
 static GdkPixbuf*
@@ -1452,15 +2955,15 @@ scale_image(GdkPixbuf* source,
             ScalingMode mode,
             gint width, gint height)
 {
+    gint p_width = gdk_pixbuf_get_width(source);
+    gint p_height = gdk_pixbuf_get_height(source);
+    gdouble offset_x = 0;
+    gdouble offset_y = 0;
+    gdouble scale_x = (gdouble)width / p_width;
+    gdouble scale_y = (gdouble)height / p_height;
+
     if(mode == SCALING_MODE_ZOOMED)
     {
-        gint offset_x = 0;
-        gint offset_y = 0;
-        gint p_width = gdk_pixbuf_get_width(source);
-        gint p_height = gdk_pixbuf_get_height(source);
-        gdouble scale_x = (gdouble)width / p_width;
-        gdouble scale_y = (gdouble)height / p_height;
-
         if(scale_x < scale_y)
         {
             scale_x = scale_y;
@@ -1471,19 +2974,25 @@ scale_image(GdkPixbuf* source,
             scale_y = scale_x;
             offset_y = (height - (p_height * scale_y)) / 2;
         }
-
-        GdkPixbuf *pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE,
-                                           gdk_pixbuf_get_bits_per_sample (source),
-                                           width, height);
-        gdk_pixbuf_composite(source, pixbuf, 0, 0, width, height,
-                             offset_x, offset_y, scale_x, scale_y, GDK_INTERP_BILINEAR, 0xFF);
-        return pixbuf;
     }
-    else if(mode == SCALING_MODE_STRETCHED)
-    {
-        return gdk_pixbuf_scale_simple(source, width, height, GDK_INTERP_BILINEAR);
-    }
-    return GDK_PIXBUF(g_object_ref(source));
+    else if(mode != SCALING_MODE_STRETCHED)
+        return GDK_PIXBUF(g_object_ref(source));
+
+    if(p_width == width && p_height == height)
+        return GDK_PIXBUF(g_object_ref(source));
+
+    /* Result has alpha channel only if source has one: opaque images are scaled as 3 channels,
+     * 25% less pixels to filter, and are converted to CAIRO_FORMAT_RGB24 later */
+    gboolean has_alpha = gdk_pixbuf_get_has_alpha(source);
+    GdkPixbuf *pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, has_alpha, 8, width, height);
+    if(!pixbuf)
+        return NULL;
+
+    greeter_scale_pixels(gdk_pixbuf_get_pixels(source), p_width, p_height, gdk_pixbuf_get_rowstride(source),
+                         gdk_pixbuf_get_pixels(pixbuf), width, height, gdk_pixbuf_get_rowstride(pixbuf),
+                         has_alpha ? 4 : 3,
+                         offset_x, offset_y, scale_x, scale_y);
+    return pixbuf;
 }
 
 /* The following code for setting a RetainPermanent background pixmap was taken
@@ -1523,6 +3032,112 @@ create_root_surface(GdkScreen* screen)
     return surface;
 }
 
+/* Upload monitors areas of image to root pixmap, using shared memory when X server is local */
+static void
+put_root_image(cairo_surface_t* root,
+               cairo_surface_t* image,
+               const GdkRectangle* rects,
+               gsize rects_size)
+{
+    Display* display = cairo_xlib_surface_get_display(root);
+    Drawable drawable = cairo_xlib_surface_get_drawable(root);
+    Visual* visual = cairo_xlib_surface_get_visual(root);
+    gint width = cairo_image_surface_get_width(image);
+    gint height = cairo_image_surface_get_height(image);
+    gint stride = cairo_image_surface_get_stride(image);
+    const guchar* data = cairo_image_surface_get_data(image);
+    gsize i;
+
+    /* Unusual visual: let cairo convert pixels */
+    if(cairo_xlib_surface_get_depth(root) != 24 || !visual ||
+       visual->red_mask != 0xff0000 || visual->green_mask != 0x00ff00 || visual->blue_mask != 0x0000ff)
+    {
+        cairo_t* cr = cairo_create(root);
+        cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+        cairo_paint(cr);
+        cairo_set_source_surface(cr, image, 0, 0);
+        for(i = 0; i < rects_size; ++i)
+            cairo_rectangle(cr, rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+        cairo_fill(cr);
+        cairo_destroy(cr);
+        return;
+    }
+
+    cairo_surface_flush(root);
+    GC gc = XCreateGC(display, drawable, 0, NULL);
+
+    /* Areas not covered by monitors */
+    XSetForeground(display, gc, WhitePixel(display, DefaultScreen(display)));
+    XFillRectangle(display, drawable, gc, 0, 0, width, height);
+
+    XShmSegmentInfo shm_info = {0};
+    XImage* ximage = NULL;
+    gboolean shm_attached = FALSE;
+
+    if(XShmQueryExtension(display))
+    {
+        ximage = XShmCreateImage(display, visual, 24, ZPixmap, NULL, &shm_info, width, height);
+        if(ximage)
+            shm_info.shmid = shmget(IPC_PRIVATE, (gsize)ximage->bytes_per_line*ximage->height, IPC_CREAT | 0600);
+        if(ximage && shm_info.shmid != -1)
+        {
+            shm_info.shmaddr = ximage->data = shmat(shm_info.shmid, NULL, 0);
+            shm_info.readOnly = True;
+            if(shm_info.shmaddr != (gchar*)-1)
+            {
+                /* Attaching fails for remote X server */
+                gdk_error_trap_push();
+                XShmAttach(display, &shm_info);
+                XSync(display, False);
+                shm_attached = gdk_error_trap_pop() == 0;
+            }
+            /* Segment will be destroyed after detaching */
+            shmctl(shm_info.shmid, IPC_RMID, NULL);
+        }
+        if(!shm_attached && ximage)
+        {
+            if(shm_info.shmaddr && shm_info.shmaddr != (gchar*)-1)
+                shmdt(shm_info.shmaddr);
+            ximage->data = NULL;
+            XDestroyImage(ximage);
+            ximage = NULL;
+        }
+    }
+
+    if(shm_attached)
+    {
+        gint y;
+        for(y = 0; y < height; ++y)
+            memcpy(ximage->data + (gsize)y*ximage->bytes_per_line, data + (gsize)y*stride, (gsize)width*4);
+        for(i = 0; i < rects_size; ++i)
+            XShmPutImage(display, drawable, gc, ximage, rects[i].x, rects[i].y, rects[i].x, rects[i].y,
+                         rects[i].width, rects[i].height, False);
+        XSync(display, False);
+        XShmDetach(display, &shm_info);
+        shmdt(shm_info.shmaddr);
+        ximage->data = NULL;
+        XDestroyImage(ximage);
+    }
+    else
+    {
+        ximage = XCreateImage(display, visual, 24, ZPixmap, 0, (gchar*)data, width, height, 32, stride);
+        if(ximage)
+        {
+            ximage->byte_order = G_BYTE_ORDER == G_LITTLE_ENDIAN ? LSBFirst : MSBFirst;
+            for(i = 0; i < rects_size; ++i)
+                XPutImage(display, drawable, gc, ximage, rects[i].x, rects[i].y, rects[i].x, rects[i].y,
+                          rects[i].width, rects[i].height);
+            ximage->data = NULL;
+            XDestroyImage(ximage);
+        }
+    }
+
+    g_debug("[Background] Root pixmap uploaded using %s", shm_attached ? "XShm" : "XPutImage");
+
+    XFreeGC(display, gc);
+    cairo_surface_mark_dirty(root);
+}
+
 /* Sets the "ESETROOT_PMAP_ID" property to later be used to free the pixmap */
 static void
 set_root_pixmap_id(GdkScreen* screen,
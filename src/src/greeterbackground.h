@@ -20,6 +20,8 @@ typedef struct _GreeterBackgroundClass      GreeterBackgroundClass;
 GType greeter_background_get_type(void) G_GNUC_CONST;
 
 GreeterBackground* greeter_background_new           (GtkWidget* child);
+void greeter_background_set_cache_dir               (GreeterBackground* background,
+                                                     const gchar* path);
 void greeter_background_set_active_monitor_config   (GreeterBackground* background,
                                                      const gchar* value);
 void greeter_background_set_monitor_config          (GreeterBackground* background,
@@ -36,6 +38,18 @@ void greeter_background_connect                     (GreeterBackground* backgrou
                                                      GdkScreen* screen);
 void greeter_background_set_custom_background       (GreeterBackground* background,
                                                      const gchar* path);
+void greeter_background_prefetch_custom_backgrounds (GreeterBackground* background,
+                                                     const gchar* const* paths);
+gboolean greeter_background_is_custom_background_ready(GreeterBackground* background,
+                                                     const gchar* path);
+void greeter_background_set_custom_cache_limit      (GreeterBackground* background,
+                                                     gsize limit);
+void greeter_background_set_memory_limit            (GreeterBackground* background,
+                                                     gsize limit);
+void greeter_background_set_server_images           (GreeterBackground* background,
+                                                     gboolean enabled);
+void greeter_background_prepare_xroot               (GreeterBackground* background);
+void greeter_background_discard_xroot               (GreeterBackground* background);
 void greeter_background_save_xroot                  (GreeterBackground* background);
 const GdkRectangle* greeter_background_get_active_monitor_geometry(GreeterBackground* background);
 void greeter_background_add_accel_group             (GreeterBackground* background,
@@ -0,0 +1,197 @@
+#include "greeterblend.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BLEND_HAVE_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BLEND_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*BlendRowFunc)(guint32* dest, const guint32* from, const guint32* to, gsize n_pixels, guint weight);
+
+static void blend_select_implementation             (void);
+static void blend_crossfade_row_generic             (guint32* dest,
+                                                     const guint32* from,
+                                                     const guint32* to,
+                                                     gsize n_pixels,
+                                                     guint weight);
+#ifdef BLEND_HAVE_X86
+static void blend_crossfade_row_sse2                (guint32* dest,
+                                                     const guint32* from,
+                                                     const guint32* to,
+                                                     gsize n_pixels,
+                                                     guint weight);
+static void blend_crossfade_row_avx2                (guint32* dest,
+                                                     const guint32* from,
+                                                     const guint32* to,
+                                                     gsize n_pixels,
+                                                     guint weight);
+#endif
+#ifdef BLEND_HAVE_NEON
+static void blend_crossfade_row_neon                (guint32* dest,
+                                                     const guint32* from,
+                                                     const guint32* to,
+                                                     gsize n_pixels,
+                                                     guint weight);
+#endif
+
+static BlendRowFunc blend_crossfade_row_impl = NULL;
+static const gchar* blend_implementation_name = NULL;
+
+void
+greeter_blend_crossfade_row(guint32* dest,
+                            const guint32* from,
+                            const guint32* to,
+                            gsize n_pixels,
+                            guint weight)
+{
+    if(!blend_crossfade_row_impl)
+        blend_select_implementation();
+    blend_crossfade_row_impl(dest, from, to, n_pixels, MIN(weight, GREETER_BLEND_WEIGHT_MAX));
+}
+
+const gchar*
+greeter_blend_get_implementation(void)
+{
+    if(!blend_crossfade_row_impl)
+        blend_select_implementation();
+    return blend_implementation_name;
+}
+
+static void
+blend_select_implementation(void)
+{
+    blend_crossfade_row_impl = blend_crossfade_row_generic;
+    blend_implementation_name = "generic";
+
+    #ifdef BLEND_HAVE_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        blend_crossfade_row_impl = blend_crossfade_row_avx2;
+        blend_implementation_name = "avx2";
+    }
+    else if(__builtin_cpu_supports("sse2"))
+    {
+        blend_crossfade_row_impl = blend_crossfade_row_sse2;
+        blend_implementation_name = "sse2";
+    }
+    #endif
+
+    #ifdef BLEND_HAVE_NEON
+    blend_crossfade_row_impl = blend_crossfade_row_neon;
+    blend_implementation_name = "neon";
+    #endif
+
+    g_debug("[Blend] Using %s crossfade implementation", blend_implementation_name);
+}
+
+/* Every channel: (from*(256 - weight) + to*weight) >> 8, result never exceeds 255 */
+static void
+blend_crossfade_row_generic(guint32* dest,
+                            const guint32* from,
+                            const guint32* to,
+                            gsize n_pixels,
+                            guint weight)
+{
+    const guint inv_weight = GREETER_BLEND_WEIGHT_MAX - weight;
+    gsize i;
+    for(i = 0; i < n_pixels; ++i)
+    {
+        const guint32 a = from[i];
+        const guint32 b = to[i];
+        /* Two channels at once: 0x00XX00XX */
+        const guint32 rb = (((a & 0x00ff00ff)*inv_weight + (b & 0x00ff00ff)*weight) >> 8) & 0x00ff00ff;
+        const guint32 ag = ((((a >> 8) & 0x00ff00ff)*inv_weight + ((b >> 8) & 0x00ff00ff)*weight) >> 8) & 0x00ff00ff;
+        dest[i] = rb | (ag << 8);
+    }
+}
+
+#ifdef BLEND_HAVE_X86
+__attribute__((target("sse2")))
+static void
+blend_crossfade_row_sse2(guint32* dest,
+                         const guint32* from,
+                         const guint32* to,
+                         gsize n_pixels,
+                         guint weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w = _mm_set1_epi16(weight);
+    const __m128i iw = _mm_set1_epi16(GREETER_BLEND_WEIGHT_MAX - weight);
+    gsize i = 0;
+
+    for(; i + 4 <= n_pixels; i += 4)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(from + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(to + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), iw),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), iw),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w));
+        lo = _mm_srli_epi16(lo, 8);
+        hi = _mm_srli_epi16(hi, 8);
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_packus_epi16(lo, hi));
+    }
+
+    blend_crossfade_row_generic(dest + i, from + i, to + i, n_pixels - i, weight);
+}
+
+__attribute__((target("avx2")))
+static void
+blend_crossfade_row_avx2(guint32* dest,
+                         const guint32* from,
+                         const guint32* to,
+                         gsize n_pixels,
+                         guint weight)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i w = _mm256_set1_epi16(weight);
+    const __m256i iw = _mm256_set1_epi16(GREETER_BLEND_WEIGHT_MAX - weight);
+    gsize i = 0;
+
+    /* unpack/pack work within 128-bit lanes, so pixel order is preserved */
+    for(; i + 8 <= n_pixels; i += 8)
+    {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(from + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(to + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), iw),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), w));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), iw),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), w));
+        lo = _mm256_srli_epi16(lo, 8);
+        hi = _mm256_srli_epi16(hi, 8);
+        _mm256_storeu_si256((__m256i*)(dest + i), _mm256_packus_epi16(lo, hi));
+    }
+
+    blend_crossfade_row_sse2(dest + i, from + i, to + i, n_pixels - i, weight);
+}
+#endif
+
+#ifdef BLEND_HAVE_NEON
+static void
+blend_crossfade_row_neon(guint32* dest,
+                         const guint32* from,
+                         const guint32* to,
+                         gsize n_pixels,
+                         guint weight)
+{
+    const uint16_t w = weight;
+    const uint16_t iw = GREETER_BLEND_WEIGHT_MAX - weight;
+    gsize i = 0;
+
+    for(; i + 4 <= n_pixels; i += 4)
+    {
+        const uint8x16_t a = vld1q_u8((const uint8_t*)(from + i));
+        const uint8x16_t b = vld1q_u8((const uint8_t*)(to + i));
+        uint16x8_t lo = vmulq_n_u16(vmovl_u8(vget_low_u8(a)), iw);
+        uint16x8_t hi = vmulq_n_u16(vmovl_u8(vget_high_u8(a)), iw);
+        lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(b)), w);
+        hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(b)), w);
+        vst1q_u8((uint8_t*)(dest + i), vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+
+    blend_crossfade_row_generic(dest + i, from + i, to + i, n_pixels - i, weight);
+}
+#endif
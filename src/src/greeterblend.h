@@ -0,0 +1,22 @@
+#ifndef GREETER_BLEND_H
+#define GREETER_BLEND_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Maximal value of crossfade weight (weight == GREETER_BLEND_WEIGHT_MAX: dest = to) */
+#define GREETER_BLEND_WEIGHT_MAX 256
+
+/* Blend two rows of 32-bit premultiplied pixels: dest = from*(1 - weight/256) + to*weight/256.
+ * Implementation (AVX2, SSE2, NEON or generic) is selected at runtime on first call. */
+void greeter_blend_crossfade_row                    (guint32* dest,
+                                                     const guint32* from,
+                                                     const guint32* to,
+                                                     gsize n_pixels,
+                                                     guint weight);
+const gchar* greeter_blend_get_implementation       (void);
+
+G_END_DECLS
+
+#endif // GREETER_BLEND_H
@@ -0,0 +1,301 @@
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "greeterimagecache.h"
+
+/* File layout: <ImageCacheHeader> <path> <padding to IMAGE_CACHE_DATA_ALIGN> <pixels> */
+typedef struct
+{
+    gchar magic[8];
+    /* Source file state */
+    gint64 mtime;
+    gint64 size;
+    /* Requested parameters */
+    gint32 mode;
+    gint32 width;
+    gint32 height;
+    /* Stored image */
+    gint32 image_width;
+    gint32 image_height;
+    gint32 stride;
+    /* cairo_format_t */
+    gint32 format;
+    gint32 path_length;
+} ImageCacheHeader;
+
+static const gchar IMAGE_CACHE_MAGIC[8] = {'L', 'G', 'G', 'I', 'M', 'G', '0', '2'};
+static const cairo_user_data_key_t IMAGE_CACHE_MAPPING_KEY;
+#define IMAGE_CACHE_DATA_ALIGN 64
+static const gchar* IMAGE_CACHE_SUFFIX = ".cache";
+/* Temporary files left by interrupted stores are removed after this time (seconds) */
+static const gint64 IMAGE_CACHE_TMP_LIFETIME = 60*60;
+
+/* Cache file found by greeter_image_cache_trim() */
+typedef struct
+{
+    gchar* filename;
+    gint64 size;
+    gint64 mtime;
+} ImageCacheFile;
+
+static gchar* image_cache_get_filename              (const gchar* cache_dir,
+                                                     const gchar* path,
+                                                     gint mode,
+                                                     gint width, gint height);
+static gsize image_cache_get_data_offset            (const ImageCacheHeader* header);
+static gint image_cache_compare_files               (gconstpointer a,
+                                                     gconstpointer b);
+static void image_cache_file_free                   (ImageCacheFile* file);
+
+cairo_surface_t*
+greeter_image_cache_lookup(const gchar* cache_dir,
+                           const gchar* path,
+                           gint mode,
+                           gint width, gint height)
+{
+    g_return_val_if_fail(cache_dir != NULL && path != NULL, NULL);
+
+    GStatBuf source_stat;
+    if(g_stat(path, &source_stat) != 0)
+        return NULL;
+
+    gchar* filename = image_cache_get_filename(cache_dir, path, mode, width, height);
+    /* Writable private mapping: cairo expects mutable data, changes are never written back */
+    GMappedFile* mapping = g_mapped_file_new(filename, TRUE, NULL);
+    if(!mapping)
+    {
+        g_free(filename);
+        return NULL;
+    }
+
+    const gchar* contents = g_mapped_file_get_contents(mapping);
+    gsize length = g_mapped_file_get_length(mapping);
+    const ImageCacheHeader* header = (const ImageCacheHeader*)contents;
+
+    if(length < sizeof(ImageCacheHeader) ||
+       memcmp(header->magic, IMAGE_CACHE_MAGIC, sizeof(IMAGE_CACHE_MAGIC)) != 0 ||
+       header->mtime != (gint64)source_stat.st_mtime ||
+       header->size != (gint64)source_stat.st_size ||
+       header->mode != mode || header->width != width || header->height != height ||
+       header->image_width <= 0 || header->image_height <= 0 ||
+       (header->format != CAIRO_FORMAT_ARGB32 && header->format != CAIRO_FORMAT_RGB24) ||
+       header->stride != cairo_format_stride_for_width(header->format, header->image_width) ||
+       header->path_length != (gint32)strlen(path) ||
+       length < image_cache_get_data_offset(header) + (gsize)header->stride*header->image_height ||
+       memcmp(contents + sizeof(ImageCacheHeader), path, header->path_length) != 0)
+    {
+        g_mapped_file_unref(mapping);
+        g_free(filename);
+        return NULL;
+    }
+
+    /* File modification time is last use time for greeter_image_cache_trim() */
+    g_utime(filename, NULL);
+    g_free(filename);
+
+    /* Pixels stay in mapped file, pages are loaded on first access */
+    cairo_surface_t* surface = cairo_image_surface_create_for_data((guchar*)contents + image_cache_get_data_offset(header),
+                                                                   header->format,
+                                                                   header->image_width, header->image_height,
+                                                                   header->stride);
+    if(cairo_surface_set_user_data(surface, &IMAGE_CACHE_MAPPING_KEY, mapping,
+                                   (cairo_destroy_func_t)g_mapped_file_unref) != CAIRO_STATUS_SUCCESS)
+    {
+        cairo_surface_destroy(surface);
+        g_mapped_file_unref(mapping);
+        return NULL;
+    }
+    return surface;
+}
+
+void
+greeter_image_cache_store(const gchar* cache_dir,
+                          const gchar* path,
+                          gint mode,
+                          gint width, gint height,
+                          cairo_surface_t* image)
+{
+    g_return_if_fail(cache_dir != NULL && path != NULL);
+    g_return_if_fail(image != NULL);
+
+    if(cairo_surface_get_type(image) != CAIRO_SURFACE_TYPE_IMAGE ||
+       (cairo_image_surface_get_format(image) != CAIRO_FORMAT_ARGB32 &&
+        cairo_image_surface_get_format(image) != CAIRO_FORMAT_RGB24))
+        return;
+
+    GStatBuf source_stat;
+    if(g_stat(path, &source_stat) != 0)
+        return;
+
+    if(g_mkdir_with_parents(cache_dir, 0700) != 0)
+    {
+        g_warning("[ImageCache] Failed to create cache directory %s: %s", cache_dir, g_strerror(errno));
+        return;
+    }
+
+    ImageCacheHeader header = {{0}};
+    memcpy(header.magic, IMAGE_CACHE_MAGIC, sizeof(IMAGE_CACHE_MAGIC));
+    header.mtime = source_stat.st_mtime;
+    header.size = source_stat.st_size;
+    header.mode = mode;
+    header.width = width;
+    header.height = height;
+    header.image_width = cairo_image_surface_get_width(image);
+    header.image_height = cairo_image_surface_get_height(image);
+    header.format = cairo_image_surface_get_format(image);
+    header.stride = cairo_image_surface_get_stride(image);
+    header.path_length = strlen(path);
+
+    gchar* filename = image_cache_get_filename(cache_dir, path, mode, width, height);
+    gchar* tmp_filename = g_strdup_printf("%s.XXXXXX", filename);
+    gint fd = g_mkstemp(tmp_filename);
+    if(fd < 0)
+    {
+        g_warning("[ImageCache] Failed to create %s: %s", tmp_filename, g_strerror(errno));
+        g_free(tmp_filename);
+        g_free(filename);
+        return;
+    }
+
+    FILE* file = fdopen(fd, "wb");
+    if(!file)
+    {
+        g_warning("[ImageCache] Failed to open %s: %s", tmp_filename, g_strerror(errno));
+        close(fd);
+        g_unlink(tmp_filename);
+        g_free(tmp_filename);
+        g_free(filename);
+        return;
+    }
+
+    gsize padding = image_cache_get_data_offset(&header) - sizeof(header) - header.path_length;
+    const gchar zeros[IMAGE_CACHE_DATA_ALIGN] = {0};
+    gboolean written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       fwrite(path, 1, header.path_length, file) == (gsize)header.path_length &&
+                       fwrite(zeros, 1, padding, file) == padding;
+
+    cairo_surface_flush(image);
+    if(written)
+        written = fwrite(cairo_image_surface_get_data(image), header.stride, header.image_height, file) ==
+                  (gsize)header.image_height;
+
+    if(fclose(file) != 0)
+        written = FALSE;
+
+    if(!written || g_rename(tmp_filename, filename) != 0)
+    {
+        g_warning("[ImageCache] Failed to write %s: %s", filename, g_strerror(errno));
+        g_unlink(tmp_filename);
+    }
+    else
+        g_debug("[ImageCache] Stored: %s (%dx%d) => %s", path, width, height, filename);
+
+    g_free(tmp_filename);
+    g_free(filename);
+}
+
+void
+greeter_image_cache_trim(const gchar* cache_dir,
+                         gsize limit)
+{
+    g_return_if_fail(cache_dir != NULL);
+
+    GDir* dir = g_dir_open(cache_dir, 0, NULL);
+    if(!dir)
+        return;
+
+    GPtrArray* files = g_ptr_array_new_with_free_func((GDestroyNotify)image_cache_file_free);
+    gint64 now = g_get_real_time()/G_USEC_PER_SEC;
+    const gchar* name;
+
+    while((name = g_dir_read_name(dir)))
+    {
+        gboolean is_tmp = !g_str_has_suffix(name, IMAGE_CACHE_SUFFIX);
+        if(is_tmp && !strstr(name, IMAGE_CACHE_SUFFIX))
+            continue;
+
+        gchar* filename = g_build_filename(cache_dir, name, NULL);
+        GStatBuf file_stat;
+        if(g_stat(filename, &file_stat) != 0 || !S_ISREG(file_stat.st_mode))
+            g_free(filename);
+        else if(is_tmp)
+        {
+            if(now - (gint64)file_stat.st_mtime > IMAGE_CACHE_TMP_LIFETIME)
+                g_unlink(filename);
+            g_free(filename);
+        }
+        else
+        {
+            ImageCacheFile* file = g_new(ImageCacheFile, 1);
+            file->filename = filename;
+            file->size = file_stat.st_size;
+            file->mtime = file_stat.st_mtime;
+            g_ptr_array_add(files, file);
+        }
+    }
+    g_dir_close(dir);
+
+    /* Most recently used first, everything after limit is reached is removed */
+    g_ptr_array_sort(files, image_cache_compare_files);
+
+    gsize total = 0;
+    guint removed = 0;
+    guint i;
+    for(i = 0; i < files->len; ++i)
+    {
+        const ImageCacheFile* file = g_ptr_array_index(files, i);
+        if(total + (gsize)file->size <= limit)
+            total += file->size;
+        else if(g_unlink(file->filename) == 0)
+            ++removed;
+    }
+
+    g_debug("[ImageCache] %s: %u file(s), %" G_GSIZE_FORMAT " KiB kept, %u removed",
+            cache_dir, files->len - removed, total/1024, removed);
+    g_ptr_array_free(files, TRUE);
+}
+
+static gchar*
+image_cache_get_filename(const gchar* cache_dir,
+                         const gchar* path,
+                         gint mode,
+                         gint width, gint height)
+{
+    gchar* key = g_strdup_printf("%s\n%d %dx%d", path, mode, width, height);
+    gchar* checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key, -1);
+    gchar* name = g_strconcat(checksum, IMAGE_CACHE_SUFFIX, NULL);
+    gchar* filename = g_build_filename(cache_dir, name, NULL);
+    g_free(name);
+    g_free(checksum);
+    g_free(key);
+    return filename;
+}
+
+static gsize
+image_cache_get_data_offset(const ImageCacheHeader* header)
+{
+    gsize offset = sizeof(ImageCacheHeader) + header->path_length;
+    return (offset + IMAGE_CACHE_DATA_ALIGN - 1)/IMAGE_CACHE_DATA_ALIGN*IMAGE_CACHE_DATA_ALIGN;
+}
+
+static gint
+image_cache_compare_files(gconstpointer a,
+                          gconstpointer b)
+{
+    const ImageCacheFile* file_a = *(const ImageCacheFile* const*)a;
+    const ImageCacheFile* file_b = *(const ImageCacheFile* const*)b;
+    if(file_a->mtime != file_b->mtime)
+        return file_a->mtime > file_b->mtime ? -1 : 1;
+    return 0;
+}
+
+static void
+image_cache_file_free(ImageCacheFile* file)
+{
+    g_free(file->filename);
+    g_free(file);
+}
@@ -0,0 +1,30 @@
+#ifndef GREETER_IMAGE_CACHE_H
+#define GREETER_IMAGE_CACHE_H
+
+#include <glib.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+/* Persistent cache of scaled images, stored as ready to use cairo image surfaces.
+ * Entries are keyed by source path, its mtime and size, scaling mode and target size.
+ * Entries replaced by changed sources are never hit again and are removed by greeter_image_cache_trim().
+ * Functions do not use any global state and can be called from any thread. */
+
+cairo_surface_t* greeter_image_cache_lookup         (const gchar* cache_dir,
+                                                     const gchar* path,
+                                                     gint mode,
+                                                     gint width, gint height);
+void greeter_image_cache_store                      (const gchar* cache_dir,
+                                                     const gchar* path,
+                                                     gint mode,
+                                                     gint width, gint height,
+                                                     cairo_surface_t* image);
+/* Remove least recently used entries until total size is below limit (bytes).
+ * Reads whole directory: call it from worker thread. */
+void greeter_image_cache_trim                       (const gchar* cache_dir,
+                                                     gsize limit);
+
+G_END_DECLS
+
+#endif // GREETER_IMAGE_CACHE_H
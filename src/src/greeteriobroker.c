@@ -0,0 +1,281 @@
+#include "greeteriobroker.h"
+#include "greetertrace.h"
+
+typedef enum
+{
+    IO_REQUEST_QUEUED,
+    IO_REQUEST_RUNNING,
+    /* Completed before worker started it, func is not called */
+    IO_REQUEST_ABANDONED,
+    IO_REQUEST_FINISHED
+} IORequestState;
+
+typedef struct
+{
+    /* Atomic: main thread, worker and cancellation idles hold references */
+    gint ref_count;
+    /* Atomic <IORequestState> */
+    gint state;
+
+    gchar* path;
+    GreeterIOFunc func;
+    gpointer data;
+    GDestroyNotify data_free;
+    GDestroyNotify result_free;
+    GreeterIOCallback callback;
+    gpointer user_data;
+
+    /* Written by worker, read in main thread after worker finished */
+    gpointer result;
+    GError* error;
+
+    /* Main thread only */
+    gboolean completed;
+    /* Worker was still busy when request was completed, see io_stalled_workers */
+    gboolean stalled;
+    GCancellable* cancellable;
+    gulong cancelled_id;
+    /* Milliseconds, counted from start of worker: time in queue is not included */
+    guint timeout;
+    guint timeout_id;
+    gint64 submitted;
+} IORequest;
+
+static GThreadPool* io_pool = NULL;
+static gint io_pool_size = 0;
+/* Workers busy with completed (timed out or cancelled) requests, pool is extended by this number */
+static gint io_stalled_workers = 0;
+
+static IORequest* io_request_ref                    (IORequest* request);
+static void io_request_unref                        (IORequest* request);
+static void io_request_complete                     (IORequest* request,
+                                                     gpointer result,
+                                                     const GError* error);
+static void io_request_run                          (IORequest* request,
+                                                     gpointer user_data);
+static gboolean io_request_started_cb               (IORequest* request);
+static gboolean io_request_finished_cb              (IORequest* request);
+static gboolean io_request_timeout_cb               (IORequest* request);
+static void io_request_cancelled_cb                 (GCancellable* cancellable,
+                                                     IORequest* request);
+static gboolean io_request_cancelled_idle_cb        (IORequest* request);
+static void io_request_cancel                       (IORequest* request);
+static void io_request_abandon                      (IORequest* request);
+static void io_pool_update_max_threads              (void);
+
+void
+greeter_io_broker_submit(const gchar* path,
+                         guint timeout,
+                         GCancellable* cancellable,
+                         GreeterIOFunc func,
+                         gpointer data,
+                         GDestroyNotify data_free,
+                         GDestroyNotify result_free,
+                         GreeterIOCallback callback,
+                         gpointer user_data)
+{
+    g_return_if_fail(path != NULL && func != NULL);
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    if(!io_pool)
+    {
+        GError* error = NULL;
+        io_pool_size = CLAMP(g_get_num_processors(), 2, 8);
+        io_pool = g_thread_pool_new((GFunc)io_request_run, NULL, io_pool_size, FALSE, &error);
+        if(!io_pool)
+        {
+            g_warning("[IO] Failed to create worker threads, reading files synchronously: %s",
+                      error ? error->message : "unknown error");
+            g_clear_error(&error);
+        }
+    }
+
+    IORequest* request = g_new0(IORequest, 1);
+    /* Main thread reference is released on completion, worker reference in io_request_finished_cb() */
+    request->ref_count = 2;
+    request->state = IO_REQUEST_QUEUED;
+    request->path = g_strdup(path);
+    request->func = func;
+    request->data = data;
+    request->data_free = data_free;
+    request->result_free = result_free;
+    request->callback = callback;
+    request->user_data = user_data;
+    request->timeout = timeout;
+    request->submitted = g_get_monotonic_time();
+
+    if(cancellable)
+    {
+        request->cancellable = g_object_ref(cancellable);
+        request->cancelled_id = g_cancellable_connect(cancellable, G_CALLBACK(io_request_cancelled_cb),
+                                                      request, NULL);
+    }
+
+    if(io_pool)
+        g_thread_pool_push(io_pool, request, NULL);
+    else
+        io_request_run(request, NULL);
+}
+
+static IORequest*
+io_request_ref(IORequest* request)
+{
+    g_atomic_int_inc(&request->ref_count);
+    return request;
+}
+
+/* Last reference is always released in main thread */
+static void
+io_request_unref(IORequest* request)
+{
+    if(!g_atomic_int_dec_and_test(&request->ref_count))
+        return;
+
+    if(request->data_free)
+        request->data_free(request->data);
+    if(request->result && request->result_free)
+        request->result_free(request->result);
+    g_clear_error(&request->error);
+    g_clear_object(&request->cancellable);
+    g_free(request->path);
+    g_free(request);
+}
+
+static void
+io_request_complete(IORequest* request,
+                    gpointer result,
+                    const GError* error)
+{
+    request->completed = TRUE;
+    if(request->timeout_id)
+    {
+        g_source_remove(request->timeout_id);
+        request->timeout_id = 0;
+    }
+    if(request->cancelled_id)
+    {
+        g_cancellable_disconnect(request->cancellable, request->cancelled_id);
+        request->cancelled_id = 0;
+    }
+
+    if(request->callback)
+        request->callback(request->path, result, error, request->user_data);
+    else if(result && request->result_free)
+        request->result_free(result);
+    io_request_unref(request);
+}
+
+static void
+io_request_run(IORequest* request,
+               gpointer user_data)
+{
+    /* Request can be timed out or cancelled while waiting in queue */
+    if(g_atomic_int_compare_and_exchange(&request->state, IO_REQUEST_QUEUED, IO_REQUEST_RUNNING))
+    {
+        /* Dispatched before io_request_finished_cb(): higher priority */
+        if(request->timeout)
+            g_idle_add_full(G_PRIORITY_HIGH, (GSourceFunc)io_request_started_cb,
+                            io_request_ref(request), (GDestroyNotify)io_request_unref);
+        GREETER_TRACE_BEGIN("io_request");
+        request->result = request->func(request->path, request->data, &request->error);
+        GREETER_TRACE_END("io_request");
+        g_atomic_int_set(&request->state, IO_REQUEST_FINISHED);
+    }
+    g_idle_add_full(G_PRIORITY_DEFAULT, (GSourceFunc)io_request_finished_cb, request, NULL);
+}
+
+static gboolean
+io_request_started_cb(IORequest* request)
+{
+    if(!request->completed)
+        request->timeout_id = g_timeout_add_full(G_PRIORITY_DEFAULT, request->timeout,
+                                                 (GSourceFunc)io_request_timeout_cb, request, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+io_request_finished_cb(IORequest* request)
+{
+    if(request->stalled)
+    {
+        g_debug("[IO] Stalled request finished after %" G_GINT64_FORMAT " ms: %s",
+                (g_get_monotonic_time() - request->submitted)/1000, request->path);
+        --io_stalled_workers;
+        io_pool_update_max_threads();
+    }
+
+    /* Result is not delivered if cancellation is still waiting in queue of idles */
+    if(!request->completed && request->cancellable && g_cancellable_is_cancelled(request->cancellable))
+        io_request_cancel(request);
+    else if(!request->completed)
+    {
+        gpointer result = request->result;
+        request->result = NULL;
+        io_request_complete(request, result, request->error);
+    }
+
+    io_request_unref(request);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+io_request_timeout_cb(IORequest* request)
+{
+    request->timeout_id = 0;
+    io_request_abandon(request);
+
+    g_warning("[IO] Timeout reading %s, %d worker(s) stalled", request->path, io_stalled_workers);
+
+    GError* error = g_error_new(G_IO_ERROR, G_IO_ERROR_TIMED_OUT, "Timeout reading %s", request->path);
+    io_request_complete(request, NULL, error);
+    g_error_free(error);
+    return G_SOURCE_REMOVE;
+}
+
+/* Can be called from any thread, from inside of g_cancellable_connect() too: completion is deferred */
+static void
+io_request_cancelled_cb(GCancellable* cancellable,
+                        IORequest* request)
+{
+    g_idle_add_full(G_PRIORITY_DEFAULT, (GSourceFunc)io_request_cancelled_idle_cb,
+                    io_request_ref(request), (GDestroyNotify)io_request_unref);
+}
+
+static gboolean
+io_request_cancelled_idle_cb(IORequest* request)
+{
+    if(!request->completed)
+        io_request_cancel(request);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+io_request_cancel(IORequest* request)
+{
+    io_request_abandon(request);
+
+    GError* error = g_error_new(G_IO_ERROR, G_IO_ERROR_CANCELLED, "Reading %s cancelled", request->path);
+    io_request_complete(request, NULL, error);
+    g_error_free(error);
+}
+
+/* Request is going to be completed without result: worker must not start it,
+ * or, if it is already running, it can not be interrupted and another thread takes its place */
+static void
+io_request_abandon(IORequest* request)
+{
+    if(!g_atomic_int_compare_and_exchange(&request->state, IO_REQUEST_QUEUED, IO_REQUEST_ABANDONED) &&
+       g_atomic_int_get(&request->state) == IO_REQUEST_RUNNING)
+    {
+        request->stalled = TRUE;
+        ++io_stalled_workers;
+        io_pool_update_max_threads();
+    }
+}
+
+static void
+io_pool_update_max_threads(void)
+{
+    if(io_pool)
+        g_thread_pool_set_max_threads(io_pool, io_pool_size + io_stalled_workers, NULL);
+}
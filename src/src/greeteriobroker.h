@@ -0,0 +1,43 @@
+#ifndef GREETER_IO_BROKER_H
+#define GREETER_IO_BROKER_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* Reads files that may be slow to access (e.g. users' home directories on NFS) in worker threads.
+ * Main thread never waits for a request: it is completed with G_IO_ERROR_TIMED_OUT when worker
+ * does not finish it within timeout (time in queue is not counted) or with G_IO_ERROR_CANCELLED
+ * when cancellable is cancelled, even if worker is still blocked.
+ * Stalled workers are replaced, other requests do not queue behind them.
+ * Functions must be called from main thread. */
+
+/* Called in worker thread: do not touch anything except arguments.
+ * Returns NULL and sets error on failure. */
+typedef gpointer (*GreeterIOFunc)                   (const gchar* path,
+                                                     gpointer data,
+                                                     GError** error);
+/* Called in main thread exactly once per request, result (can be NULL) is owned by callback.
+ * Request data is still valid here. */
+typedef void (*GreeterIOCallback)                   (const gchar* path,
+                                                     gpointer result,
+                                                     const GError* error,
+                                                     gpointer user_data);
+
+/* timeout: milliseconds from start of worker, 0 for no limit
+ * callback: can be NULL, result is released by result_free then
+ * data_free: called in main thread when both worker and callback are done with data
+ * result_free: releases results that arrived after request was completed */
+void greeter_io_broker_submit                       (const gchar* path,
+                                                     guint timeout,
+                                                     GCancellable* cancellable,
+                                                     GreeterIOFunc func,
+                                                     gpointer data,
+                                                     GDestroyNotify data_free,
+                                                     GDestroyNotify result_free,
+                                                     GreeterIOCallback callback,
+                                                     gpointer user_data);
+
+G_END_DECLS
+
+#endif // GREETER_IO_BROKER_H
@@ -0,0 +1,243 @@
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "greeterlayoutcache.h"
+
+/* File layout: <LayoutCacheHeader> <locale> <padding to 4> <LayoutCacheEntry * n_entries> <strings>
+ * Entries are sorted by key, offsets point into strings block */
+typedef struct
+{
+    gchar magic[8];
+    /* Rules file state */
+    gint64 mtime;
+    gint64 size;
+    gint32 locale_length;
+    guint32 n_entries;
+    guint32 strings_size;
+} LayoutCacheHeader;
+
+typedef struct
+{
+    guint32 key;
+    guint32 value;
+} LayoutCacheEntry;
+
+struct _GreeterLayoutCache
+{
+    GMappedFile* mapping;
+    const LayoutCacheEntry* entries;
+    guint32 n_entries;
+    const gchar* strings;
+};
+
+static const gchar LAYOUT_CACHE_MAGIC[8] = {'L', 'G', 'G', 'X', 'K', 'B', '0', '1'};
+#define LAYOUT_CACHE_ENTRIES_ALIGN 4
+
+static gsize layout_cache_get_entries_offset        (gint32 locale_length);
+static gchar* layout_cache_get_key                  (const gchar* layout,
+                                                     const gchar* variant);
+static gint layout_cache_compare_keys               (gconstpointer a,
+                                                     gconstpointer b);
+
+GreeterLayoutCache*
+greeter_layout_cache_open(const gchar* filename,
+                          const gchar* rules_path,
+                          const gchar* locale)
+{
+    g_return_val_if_fail(filename != NULL && rules_path != NULL, NULL);
+
+    if(!locale)
+        locale = "";
+
+    GStatBuf rules_stat;
+    if(g_stat(rules_path, &rules_stat) != 0)
+        return NULL;
+
+    GMappedFile* mapping = g_mapped_file_new(filename, FALSE, NULL);
+    if(!mapping)
+        return NULL;
+
+    const gchar* contents = g_mapped_file_get_contents(mapping);
+    gsize length = g_mapped_file_get_length(mapping);
+    const LayoutCacheHeader* header = (const LayoutCacheHeader*)contents;
+    gsize entries_offset = 0;
+    gsize strings_offset = 0;
+
+    /* Offsets are checked against file length before anything behind header is read */
+    if(length >= sizeof(LayoutCacheHeader) &&
+       memcmp(header->magic, LAYOUT_CACHE_MAGIC, sizeof(LAYOUT_CACHE_MAGIC)) == 0 &&
+       header->locale_length >= 0)
+    {
+        entries_offset = layout_cache_get_entries_offset(header->locale_length);
+        if(entries_offset <= length &&
+           header->n_entries <= (length - entries_offset)/sizeof(LayoutCacheEntry))
+            strings_offset = entries_offset + (gsize)header->n_entries*sizeof(LayoutCacheEntry);
+    }
+
+    if(strings_offset == 0 ||
+       header->strings_size == 0 ||
+       length != strings_offset + header->strings_size ||
+       header->mtime != (gint64)rules_stat.st_mtime ||
+       header->size != (gint64)rules_stat.st_size ||
+       header->locale_length != (gint32)strlen(locale) ||
+       memcmp(contents + sizeof(LayoutCacheHeader), locale, header->locale_length) != 0 ||
+       contents[length - 1] != '\0')
+    {
+        g_mapped_file_unref(mapping);
+        return NULL;
+    }
+
+    /* Checked once here, lookups can trust offsets */
+    const LayoutCacheEntry* entries = (const LayoutCacheEntry*)(contents + entries_offset);
+    guint32 i;
+    for(i = 0; i < header->n_entries; ++i)
+    {
+        if(entries[i].key >= header->strings_size || entries[i].value >= header->strings_size)
+        {
+            g_mapped_file_unref(mapping);
+            return NULL;
+        }
+    }
+
+    GreeterLayoutCache* cache = g_new0(GreeterLayoutCache, 1);
+    cache->mapping = mapping;
+    cache->entries = entries;
+    cache->n_entries = header->n_entries;
+    cache->strings = contents + strings_offset;
+    return cache;
+}
+
+void
+greeter_layout_cache_free(GreeterLayoutCache* cache)
+{
+    if(!cache)
+        return;
+    g_mapped_file_unref(cache->mapping);
+    g_free(cache);
+}
+
+const gchar*
+greeter_layout_cache_lookup(GreeterLayoutCache* cache,
+                            const gchar* layout,
+                            const gchar* variant)
+{
+    g_return_val_if_fail(cache != NULL && layout != NULL, NULL);
+
+    gchar* key = layout_cache_get_key(layout, variant);
+    const gchar* value = NULL;
+    guint32 low = 0;
+    guint32 high = cache->n_entries;
+
+    while(low < high)
+    {
+        guint32 middle = low + (high - low)/2;
+        gint cmp = strcmp(key, cache->strings + cache->entries[middle].key);
+        if(cmp == 0)
+        {
+            value = cache->strings + cache->entries[middle].value;
+            break;
+        }
+        if(cmp < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    g_free(key);
+    return value;
+}
+
+gboolean
+greeter_layout_cache_store(const gchar* filename,
+                           const gchar* rules_path,
+                           const gchar* locale,
+                           GHashTable* descriptions)
+{
+    g_return_val_if_fail(filename != NULL && rules_path != NULL, FALSE);
+    g_return_val_if_fail(descriptions != NULL, FALSE);
+
+    if(!locale)
+        locale = "";
+
+    GStatBuf rules_stat;
+    if(g_stat(rules_path, &rules_stat) != 0)
+        return FALSE;
+
+    guint n_keys = 0;
+    gchar** keys = (gchar**)g_hash_table_get_keys_as_array(descriptions, &n_keys);
+    qsort(keys, n_keys, sizeof(gchar*), layout_cache_compare_keys);
+
+    LayoutCacheHeader header = {{0}};
+    memcpy(header.magic, LAYOUT_CACHE_MAGIC, sizeof(LAYOUT_CACHE_MAGIC));
+    header.mtime = rules_stat.st_mtime;
+    header.size = rules_stat.st_size;
+    header.locale_length = strlen(locale);
+    header.n_entries = n_keys;
+
+    gsize entries_offset = layout_cache_get_entries_offset(header.locale_length);
+    GString* data = g_string_sized_new(entries_offset + n_keys*sizeof(LayoutCacheEntry));
+    g_string_append_len(data, (const gchar*)&header, sizeof(header));
+    g_string_append_len(data, locale, header.locale_length);
+    g_string_set_size(data, entries_offset + n_keys*sizeof(LayoutCacheEntry));
+    memset(data->str + sizeof(header) + header.locale_length, 0, data->len - sizeof(header) - header.locale_length);
+
+    /* Strings block starts with empty string: offset 0 is never a valid key */
+    gsize strings_offset = data->len;
+    g_string_append_c(data, '\0');
+
+    guint i;
+    for(i = 0; i < n_keys; ++i)
+    {
+        const gchar* value = g_hash_table_lookup(descriptions, keys[i]);
+        LayoutCacheEntry entry;
+        entry.key = data->len - strings_offset;
+        g_string_append_len(data, keys[i], strlen(keys[i]) + 1);
+        entry.value = data->len - strings_offset;
+        g_string_append_len(data, value ? value : "", strlen(value ? value : "") + 1);
+        memcpy(data->str + entries_offset + i*sizeof(LayoutCacheEntry), &entry, sizeof(entry));
+    }
+    g_free(keys);
+
+    header.strings_size = data->len - strings_offset;
+    memcpy(data->str, &header, sizeof(header));
+
+    GError* error = NULL;
+    gchar* dirname = g_path_get_dirname(filename);
+    g_mkdir_with_parents(dirname, 0700);
+    g_free(dirname);
+
+    gboolean stored = g_file_set_contents(filename, data->str, data->len, &error);
+    if(stored)
+        g_debug("[LayoutCache] Stored %u descriptions for \"%s\" => %s", n_keys, locale, filename);
+    else
+        g_warning("[LayoutCache] Failed to write %s: %s", filename, error->message);
+
+    g_clear_error(&error);
+    g_string_free(data, TRUE);
+    return stored;
+}
+
+static gsize
+layout_cache_get_entries_offset(gint32 locale_length)
+{
+    gsize offset = sizeof(LayoutCacheHeader) + locale_length;
+    return (offset + LAYOUT_CACHE_ENTRIES_ALIGN - 1)/LAYOUT_CACHE_ENTRIES_ALIGN*LAYOUT_CACHE_ENTRIES_ALIGN;
+}
+
+static gchar*
+layout_cache_get_key(const gchar* layout,
+                     const gchar* variant)
+{
+    if(variant && *variant)
+        return g_strdup_printf("%s(%s)", layout, variant);
+    return g_strdup(layout);
+}
+
+static gint
+layout_cache_compare_keys(gconstpointer a,
+                          gconstpointer b)
+{
+    return strcmp(*(const gchar* const*)a, *(const gchar* const*)b);
+}
@@ -0,0 +1,31 @@
+#ifndef GREETER_LAYOUT_CACHE_H
+#define GREETER_LAYOUT_CACHE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Persistent table of keyboard layout descriptions, replaces parsing of XKB rules XML on every start.
+ * File is valid for one rules file (its mtime and size) and one locale, descriptions are translated.
+ * Keys: layout name for layouts, "layout(variant)" for variants. */
+
+typedef struct _GreeterLayoutCache GreeterLayoutCache;
+
+/* Maps cache file, returns NULL if it is missing or does not match rules file and locale */
+GreeterLayoutCache* greeter_layout_cache_open       (const gchar* filename,
+                                                     const gchar* rules_path,
+                                                     const gchar* locale);
+void greeter_layout_cache_free                      (GreeterLayoutCache* cache);
+/* Variant can be NULL or empty. Returned string is owned by cache. */
+const gchar* greeter_layout_cache_lookup            (GreeterLayoutCache* cache,
+                                                     const gchar* layout,
+                                                     const gchar* variant);
+/* descriptions: <gchar* key, gchar* description> */
+gboolean greeter_layout_cache_store                 (const gchar* filename,
+                                                     const gchar* rules_path,
+                                                     const gchar* locale,
+                                                     GHashTable* descriptions);
+
+G_END_DECLS
+
+#endif // GREETER_LAYOUT_CACHE_H
@@ -0,0 +1,436 @@
+#include <math.h>
+#include <string.h>
+
+#include "greeterscale.h"
+
+#if defined(__SSE2__)
+#define SCALE_HAVE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SCALE_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Box filter is used when image is reduced more than 1/SCALE_BOX_RATIO times:
+ * Lanczos3 would need too many taps and gives no visible difference */
+#define SCALE_BOX_RATIO     4.0
+#define SCALE_LANCZOS_LOBES 3.0
+/* Minimal band height, smaller images are scaled by calling thread only */
+#define SCALE_BAND_MIN_ROWS 64
+
+/* Source pixels contributing to one destination pixel */
+typedef struct
+{
+    gint start;
+    gint count;
+    /* Index of first weight in ScaleTable.weights */
+    gint offset;
+} ScaleContrib;
+
+/* Filter weights for one axis */
+typedef struct
+{
+    ScaleContrib* contribs;
+    gfloat* weights;
+    gint max_count;
+} ScaleTable;
+
+typedef struct
+{
+    const guchar* src;
+    gint src_stride;
+    guchar* dest;
+    gint dest_width;
+    gint dest_stride;
+    gint n_channels;
+    ScaleTable horizontal;
+    ScaleTable vertical;
+
+    GMutex mutex;
+    GCond cond;
+    gint bands_pending;
+} ScaleJob;
+
+typedef struct
+{
+    ScaleJob* job;
+    gint first_row;
+    gint last_row;
+} ScaleBand;
+
+static GThreadPool* scale_get_pool                  (void);
+static void scale_table_init                        (ScaleTable* table,
+                                                     gint src_size,
+                                                     gint dest_size,
+                                                     gdouble offset,
+                                                     gdouble scale);
+static void scale_table_clear                       (ScaleTable* table);
+static void scale_band_run                          (ScaleBand* band,
+                                                     gpointer user_data);
+static void scale_band_process                      (const ScaleJob* job,
+                                                     gint first_row,
+                                                     gint last_row);
+static void scale_row_horizontal                    (const ScaleJob* job,
+                                                     const guchar* src,
+                                                     gfloat* dest);
+static void scale_row_accumulate                    (gfloat* acc,
+                                                     const gfloat* row,
+                                                     gfloat weight,
+                                                     gsize n);
+static void scale_row_store                         (const ScaleJob* job,
+                                                     const gfloat* acc,
+                                                     guchar* dest);
+
+void
+greeter_scale_pixels(const guchar* src,
+                     gint src_width, gint src_height,
+                     gint src_stride,
+                     guchar* dest,
+                     gint dest_width, gint dest_height,
+                     gint dest_stride,
+                     gint n_channels,
+                     gdouble offset_x, gdouble offset_y,
+                     gdouble scale_x, gdouble scale_y)
+{
+    g_return_if_fail(src != NULL && dest != NULL);
+    g_return_if_fail(n_channels == 3 || n_channels == 4);
+    g_return_if_fail(src_width > 0 && src_height > 0 && dest_width > 0 && dest_height > 0);
+    g_return_if_fail(scale_x > 0 && scale_y > 0);
+
+    ScaleJob job = {0};
+    job.src = src;
+    job.src_stride = src_stride;
+    job.dest = dest;
+    job.dest_width = dest_width;
+    job.dest_stride = dest_stride;
+    job.n_channels = n_channels;
+    scale_table_init(&job.horizontal, src_width, dest_width, offset_x, scale_x);
+    scale_table_init(&job.vertical, src_height, dest_height, offset_y, scale_y);
+
+    GThreadPool* pool = scale_get_pool();
+    gint bands = MIN((gint)g_get_num_processors(), dest_height/SCALE_BAND_MIN_ROWS);
+    if(!pool || bands < 2)
+        scale_band_process(&job, 0, dest_height);
+    else
+    {
+        gint rows_per_band = (dest_height + bands - 1)/bands;
+        gint row;
+
+        g_mutex_init(&job.mutex);
+        g_cond_init(&job.cond);
+        job.bands_pending = bands - 1;
+
+        /* First band is processed by calling thread */
+        for(row = rows_per_band; row < dest_height; row += rows_per_band)
+        {
+            ScaleBand* band = g_new(ScaleBand, 1);
+            band->job = &job;
+            band->first_row = row;
+            band->last_row = MIN(row + rows_per_band, dest_height);
+            g_thread_pool_push(pool, band, NULL);
+        }
+        scale_band_process(&job, 0, MIN(rows_per_band, dest_height));
+
+        g_mutex_lock(&job.mutex);
+        while(job.bands_pending > 0)
+            g_cond_wait(&job.cond, &job.mutex);
+        g_mutex_unlock(&job.mutex);
+
+        g_cond_clear(&job.cond);
+        g_mutex_clear(&job.mutex);
+    }
+
+    scale_table_clear(&job.horizontal);
+    scale_table_clear(&job.vertical);
+}
+
+static GThreadPool*
+scale_get_pool(void)
+{
+    static gsize initialized = 0;
+    static GThreadPool* pool = NULL;
+
+    if(g_once_init_enter(&initialized))
+    {
+        GError* error = NULL;
+        pool = g_thread_pool_new((GFunc)scale_band_run, NULL, g_get_num_processors(), FALSE, &error);
+        if(!pool)
+        {
+            g_warning("[Scale] Failed to create thread pool: %s", error ? error->message : "unknown error");
+            g_clear_error(&error);
+        }
+        g_once_init_leave(&initialized, 1);
+    }
+    return pool;
+}
+
+static gdouble
+scale_lanczos(gdouble x)
+{
+    if(x == 0.0)
+        return 1.0;
+    if(x <= -SCALE_LANCZOS_LOBES || x >= SCALE_LANCZOS_LOBES)
+        return 0.0;
+    gdouble px = G_PI*x;
+    return SCALE_LANCZOS_LOBES*sin(px)*sin(px/SCALE_LANCZOS_LOBES)/(px*px);
+}
+
+static void
+scale_table_init(ScaleTable* table,
+                 gint src_size,
+                 gint dest_size,
+                 gdouble offset,
+                 gdouble scale)
+{
+    /* Filter is stretched when reducing to average all covered source pixels */
+    gdouble stretch = scale < 1.0 ? 1.0/scale : 1.0;
+    gboolean box = stretch > SCALE_BOX_RATIO;
+    gdouble support = box ? stretch/2.0 : SCALE_LANCZOS_LOBES*stretch;
+    gint max_taps = (gint)ceil(support*2.0) + 2;
+    gint x;
+
+    table->contribs = g_new(ScaleContrib, dest_size);
+    table->weights = g_new(gfloat, (gsize)dest_size*max_taps);
+    table->max_count = 1;
+
+    for(x = 0; x < dest_size; ++x)
+    {
+        ScaleContrib* contrib = &table->contribs[x];
+        gfloat* weights = &table->weights[(gsize)x*max_taps];
+        /* Center of destination pixel in source coordinates */
+        gdouble center = (x + 0.5 - offset)/scale;
+        gint first = MAX((gint)floor(center - support), 0);
+        gint last = MIN((gint)ceil(center + support), src_size);
+        gdouble sum = 0.0;
+        gint i;
+
+        contrib->offset = x*max_taps;
+        contrib->start = first;
+        contrib->count = 0;
+
+        for(i = first; i < last && contrib->count < max_taps; ++i)
+        {
+            gdouble weight;
+            if(box) /* Part of source pixel [i, i + 1) covered by destination pixel */
+                weight = MAX(0.0, MIN(i + 1.0, center + support) - MAX((gdouble)i, center - support));
+            else
+                weight = scale_lanczos((i + 0.5 - center)/stretch);
+            weights[contrib->count++] = weight;
+            sum += weight;
+        }
+
+        if(contrib->count == 0 || fabs(sum) < 1e-6)
+        {
+            /* Destination pixel is outside of source: repeat nearest edge pixel */
+            contrib->start = CLAMP((gint)floor(center), 0, src_size - 1);
+            contrib->count = 1;
+            weights[0] = 1.0f;
+        }
+        else
+        {
+            /* Normalize, edge pixels get weights of taps outside of image */
+            for(i = 0; i < contrib->count; ++i)
+                weights[i] /= sum;
+        }
+
+        table->max_count = MAX(table->max_count, contrib->count);
+    }
+}
+
+static void
+scale_table_clear(ScaleTable* table)
+{
+    g_free(table->contribs);
+    g_free(table->weights);
+    table->contribs = NULL;
+    table->weights = NULL;
+}
+
+static void
+scale_band_run(ScaleBand* band,
+               gpointer user_data)
+{
+    ScaleJob* job = band->job;
+
+    scale_band_process(job, band->first_row, band->last_row);
+    g_free(band);
+
+    g_mutex_lock(&job->mutex);
+    if(--job->bands_pending == 0)
+        g_cond_signal(&job->cond);
+    g_mutex_unlock(&job->mutex);
+}
+
+/* Scale destination rows [first_row, last_row).
+ * Horizontally scaled source rows are kept in ring buffer: vertical taps of neighbouring rows overlap */
+static void
+scale_band_process(const ScaleJob* job,
+                   gint first_row,
+                   gint last_row)
+{
+    gsize row_length = (gsize)job->dest_width*job->n_channels;
+    gint ring_size = job->vertical.max_count;
+    gfloat* ring = g_new(gfloat, row_length*ring_size);
+    gint* ring_rows = g_new(gint, ring_size);
+    gfloat* acc = g_new(gfloat, row_length);
+    gint y, i;
+
+    for(i = 0; i < ring_size; ++i)
+        ring_rows[i] = -1;
+
+    for(y = first_row; y < last_row; ++y)
+    {
+        const ScaleContrib* contrib = &job->vertical.contribs[y];
+        const gfloat* weights = &job->vertical.weights[contrib->offset];
+
+        memset(acc, 0, row_length*sizeof(gfloat));
+        for(i = 0; i < contrib->count; ++i)
+        {
+            gint src_row = contrib->start + i;
+            gint slot = src_row % ring_size;
+            gfloat* row = ring + row_length*slot;
+
+            if(ring_rows[slot] != src_row)
+            {
+                scale_row_horizontal(job, job->src + (gsize)src_row*job->src_stride, row);
+                ring_rows[slot] = src_row;
+            }
+            scale_row_accumulate(acc, row, weights[i], row_length);
+        }
+        scale_row_store(job, acc, job->dest + (gsize)y*job->dest_stride);
+    }
+
+    g_free(acc);
+    g_free(ring_rows);
+    g_free(ring);
+}
+
+/* Source row to floats, RGBA is premultiplied to avoid dark fringes around transparent areas */
+static void
+scale_row_horizontal(const ScaleJob* job,
+                     const guchar* src,
+                     gfloat* dest)
+{
+    gint x, i;
+
+    if(job->n_channels == 4)
+    {
+        for(x = 0; x < job->dest_width; ++x)
+        {
+            const ScaleContrib* contrib = &job->horizontal.contribs[x];
+            const gfloat* weights = &job->horizontal.weights[contrib->offset];
+            const guchar* p = src + (gsize)contrib->start*4;
+            gfloat r = 0, g = 0, b = 0, a = 0;
+
+            for(i = 0; i < contrib->count; ++i, p += 4)
+            {
+                gfloat wa = weights[i]*p[3];
+                r += wa*p[0];
+                g += wa*p[1];
+                b += wa*p[2];
+                a += wa;
+            }
+            dest[0] = r/255.0f;
+            dest[1] = g/255.0f;
+            dest[2] = b/255.0f;
+            dest[3] = a;
+            dest += 4;
+        }
+    }
+    else
+    {
+        for(x = 0; x < job->dest_width; ++x)
+        {
+            const ScaleContrib* contrib = &job->horizontal.contribs[x];
+            const gfloat* weights = &job->horizontal.weights[contrib->offset];
+            const guchar* p = src + (gsize)contrib->start*3;
+            gfloat r = 0, g = 0, b = 0;
+
+            for(i = 0; i < contrib->count; ++i, p += 3)
+            {
+                r += weights[i]*p[0];
+                g += weights[i]*p[1];
+                b += weights[i]*p[2];
+            }
+            dest[0] = r;
+            dest[1] = g;
+            dest[2] = b;
+            dest += 3;
+        }
+    }
+}
+
+/* acc += row*weight, this is where vertical pass spends its time */
+static void
+scale_row_accumulate(gfloat* acc,
+                     const gfloat* row,
+                     gfloat weight,
+                     gsize n)
+{
+    gsize i = 0;
+
+    #if defined(SCALE_HAVE_SSE2)
+    __m128 w = _mm_set1_ps(weight);
+    for(; i + 8 <= n; i += 8)
+    {
+        __m128 a0 = _mm_loadu_ps(acc + i);
+        __m128 a1 = _mm_loadu_ps(acc + i + 4);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(row + i), w));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(row + i + 4), w));
+        _mm_storeu_ps(acc + i, a0);
+        _mm_storeu_ps(acc + i + 4, a1);
+    }
+    #elif defined(SCALE_HAVE_NEON)
+    float32x4_t w = vdupq_n_f32(weight);
+    for(; i + 8 <= n; i += 8)
+    {
+        vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), vld1q_f32(row + i), w));
+        vst1q_f32(acc + i + 4, vmlaq_f32(vld1q_f32(acc + i + 4), vld1q_f32(row + i + 4), w));
+    }
+    #endif
+
+    for(; i < n; ++i)
+        acc[i] += row[i]*weight;
+}
+
+static inline guchar
+scale_clamp(gfloat value)
+{
+    if(value <= 0.0f)
+        return 0;
+    if(value >= 255.0f)
+        return 255;
+    return (guchar)(value + 0.5f);
+}
+
+static void
+scale_row_store(const ScaleJob* job,
+                const gfloat* acc,
+                guchar* dest)
+{
+    gint x;
+
+    if(job->n_channels == 4)
+    {
+        for(x = 0; x < job->dest_width; ++x, acc += 4, dest += 4)
+        {
+            gfloat a = acc[3];
+            if(a < 0.5f)
+            {
+                dest[0] = dest[1] = dest[2] = dest[3] = 0;
+                continue;
+            }
+            gfloat k = 255.0f/a;
+            dest[0] = scale_clamp(acc[0]*k);
+            dest[1] = scale_clamp(acc[1]*k);
+            dest[2] = scale_clamp(acc[2]*k);
+            dest[3] = scale_clamp(a);
+        }
+    }
+    else
+    {
+        gsize i, n = (gsize)job->dest_width*3;
+        for(i = 0; i < n; ++i)
+            dest[i] = scale_clamp(acc[i]);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef GREETER_SCALE_H
+#define GREETER_SCALE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Resample 8-bit RGB (n_channels = 3) or non-premultiplied RGBA (n_channels = 4) pixels.
+ * Destination pixel x maps to source coordinate (x - offset_x)/scale_x, same for y.
+ * Lanczos3 filter is used for upscaling and moderate downscaling, box filter for large ratios.
+ * Destination is split into row bands processed by shared worker pool. Thread-safe. */
+void greeter_scale_pixels                           (const guchar* src,
+                                                     gint src_width, gint src_height,
+                                                     gint src_stride,
+                                                     guchar* dest,
+                                                     gint dest_width, gint dest_height,
+                                                     gint dest_stride,
+                                                     gint n_channels,
+                                                     gdouble offset_x, gdouble offset_y,
+                                                     gdouble scale_x, gdouble scale_y);
+
+G_END_DECLS
+
+#endif // GREETER_SCALE_H
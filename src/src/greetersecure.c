@@ -0,0 +1,332 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "greetersecure.h"
+
+/* Passwords and PAM answers only: one arena is more than enough */
+#define SECURE_ARENA_SIZE   (64*1024)
+#define SECURE_ALIGN        16
+
+/* Header of every allocated block, data follows it */
+typedef struct
+{
+    gsize size;
+    gsize used;
+} SecureBlock;
+
+G_STATIC_ASSERT(sizeof(SecureBlock) % SECURE_ALIGN == 0);
+
+static guchar* secure_arena = NULL;
+static gsize secure_arena_size = 0;
+static gsize secure_locked_bytes = 0;
+static gsize secure_used_bytes = 0;
+G_LOCK_DEFINE_STATIC(secure_arena);
+
+static void secure_arena_init                       (void);
+static gboolean secure_arena_contains               (gconstpointer mem);
+static void secure_wipe                             (gpointer mem,
+                                                     gsize size);
+
+gpointer
+greeter_secure_alloc(gsize size)
+{
+    SecureBlock* block = NULL;
+
+    size = (MAX(size, 1) + SECURE_ALIGN - 1) & ~(gsize)(SECURE_ALIGN - 1);
+
+    G_LOCK(secure_arena);
+    secure_arena_init();
+
+    /* First fit */
+    guchar* ptr = secure_arena;
+    while(ptr && ptr < secure_arena + secure_arena_size)
+    {
+        SecureBlock* iter = (SecureBlock*)ptr;
+        if(!iter->used && iter->size >= size)
+        {
+            block = iter;
+            break;
+        }
+        ptr += sizeof(SecureBlock) + iter->size;
+    }
+
+    if(block)
+    {
+        /* Split if rest is big enough for another block */
+        if(block->size >= size + sizeof(SecureBlock) + SECURE_ALIGN)
+        {
+            SecureBlock* rest = (SecureBlock*)((guchar*)block + sizeof(SecureBlock) + size);
+            rest->size = block->size - size - sizeof(SecureBlock);
+            rest->used = FALSE;
+            block->size = size;
+        }
+        block->used = TRUE;
+        secure_used_bytes += block->size;
+    }
+    G_UNLOCK(secure_arena);
+
+    if(!block)
+    {
+        /* Better than failing to log in */
+        g_warning("[Secure] Locked memory is exhausted, using unlocked memory for %" G_GSIZE_FORMAT " bytes", size);
+        block = g_malloc(sizeof(SecureBlock) + size);
+        block->size = size;
+        block->used = TRUE;
+    }
+
+    memset(block + 1, 0, block->size);
+    return block + 1;
+}
+
+void
+greeter_secure_free(gpointer mem)
+{
+    if(!mem)
+        return;
+
+    SecureBlock* block = (SecureBlock*)mem - 1;
+    secure_wipe(mem, block->size);
+
+    if(!secure_arena_contains(mem))
+    {
+        secure_wipe(block, sizeof(SecureBlock));
+        g_free(block);
+        return;
+    }
+
+    G_LOCK(secure_arena);
+    block->used = FALSE;
+    secure_used_bytes -= block->size;
+
+    /* Merge adjacent free blocks */
+    guchar* ptr = secure_arena;
+    while(ptr < secure_arena + secure_arena_size)
+    {
+        SecureBlock* iter = (SecureBlock*)ptr;
+        guchar* next = ptr + sizeof(SecureBlock) + iter->size;
+        if(!iter->used && next < secure_arena + secure_arena_size && !((SecureBlock*)next)->used)
+        {
+            iter->size += sizeof(SecureBlock) + ((SecureBlock*)next)->size;
+            continue;
+        }
+        ptr = next;
+    }
+    G_UNLOCK(secure_arena);
+}
+
+gsize
+greeter_secure_get_locked_bytes(void)
+{
+    gsize locked;
+    G_LOCK(secure_arena);
+    secure_arena_init();
+    locked = secure_locked_bytes;
+    G_UNLOCK(secure_arena);
+    return locked;
+}
+
+/* Arena is placed between two inaccessible pages: overflows crash instead of leaking into other memory */
+static void
+secure_arena_init(void)
+{
+    if(secure_arena || secure_arena_size)
+        return;
+
+    gsize page = (gsize)sysconf(_SC_PAGESIZE);
+    gsize size = (SECURE_ARENA_SIZE + page - 1)/page*page;
+
+    guchar* map = mmap(NULL, size + 2*page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(map == MAP_FAILED)
+    {
+        g_warning("[Secure] Failed to map secure memory");
+        secure_arena_size = 1; /* Do not try again */
+        return;
+    }
+
+    mprotect(map, page, PROT_NONE);
+    mprotect(map + page + size, page, PROT_NONE);
+
+    secure_arena = map + page;
+    secure_arena_size = size;
+
+    if(mlock(secure_arena, size) == 0)
+        secure_locked_bytes = size;
+    else
+        g_warning("[Secure] Failed to lock secure memory, it may be swapped out");
+    #ifdef MADV_DONTDUMP
+    madvise(secure_arena, size, MADV_DONTDUMP);
+    #endif
+
+    SecureBlock* block = (SecureBlock*)secure_arena;
+    block->size = size - sizeof(SecureBlock);
+    block->used = FALSE;
+
+    g_debug("[Secure] Locked memory: %" G_GSIZE_FORMAT " bytes", secure_locked_bytes);
+}
+
+static gboolean
+secure_arena_contains(gconstpointer mem)
+{
+    return secure_arena && (const guchar*)mem >= secure_arena && (const guchar*)mem < secure_arena + secure_arena_size;
+}
+
+static void
+secure_wipe(gpointer mem,
+            gsize size)
+{
+    /* volatile: compiler must not drop stores to memory that is freed right after */
+    volatile guchar* ptr = mem;
+    while(size--)
+        *ptr++ = 0;
+}
+
+/* GreeterSecureEntryBuffer */
+
+struct _GreeterSecureEntryBuffer
+{
+    GtkEntryBuffer parent_instance;
+    gchar* text;
+    /* Allocated size of text */
+    gsize text_size;
+    gsize text_bytes;
+    guint text_chars;
+};
+
+struct _GreeterSecureEntryBufferClass
+{
+    GtkEntryBufferClass parent_class;
+};
+
+G_DEFINE_TYPE(GreeterSecureEntryBuffer, greeter_secure_entry_buffer, GTK_TYPE_ENTRY_BUFFER);
+
+static void greeter_secure_entry_buffer_finalize    (GObject* object);
+static const gchar* greeter_secure_entry_buffer_get_text(GtkEntryBuffer* buffer,
+                                                     gsize* n_bytes);
+static guint greeter_secure_entry_buffer_get_length (GtkEntryBuffer* buffer);
+static guint greeter_secure_entry_buffer_insert_text(GtkEntryBuffer* buffer,
+                                                     guint position,
+                                                     const gchar* chars,
+                                                     guint n_chars);
+static guint greeter_secure_entry_buffer_delete_text(GtkEntryBuffer* buffer,
+                                                     guint position,
+                                                     guint n_chars);
+
+static void
+greeter_secure_entry_buffer_class_init(GreeterSecureEntryBufferClass* klass)
+{
+    GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    GtkEntryBufferClass* buffer_class = GTK_ENTRY_BUFFER_CLASS(klass);
+
+    gobject_class->finalize = greeter_secure_entry_buffer_finalize;
+    buffer_class->get_text = greeter_secure_entry_buffer_get_text;
+    buffer_class->get_length = greeter_secure_entry_buffer_get_length;
+    buffer_class->insert_text = greeter_secure_entry_buffer_insert_text;
+    buffer_class->delete_text = greeter_secure_entry_buffer_delete_text;
+}
+
+static void
+greeter_secure_entry_buffer_init(GreeterSecureEntryBuffer* self)
+{
+    self->text = NULL;
+    self->text_size = 0;
+    self->text_bytes = 0;
+    self->text_chars = 0;
+}
+
+GtkEntryBuffer*
+greeter_secure_entry_buffer_new(void)
+{
+    return GTK_ENTRY_BUFFER(g_object_new(GREETER_SECURE_ENTRY_BUFFER_TYPE, NULL));
+}
+
+static void
+greeter_secure_entry_buffer_finalize(GObject* object)
+{
+    GreeterSecureEntryBuffer* self = GREETER_SECURE_ENTRY_BUFFER(object);
+
+    greeter_secure_free(self->text);
+    self->text = NULL;
+    self->text_size = self->text_bytes = self->text_chars = 0;
+
+    G_OBJECT_CLASS(greeter_secure_entry_buffer_parent_class)->finalize(object);
+}
+
+static const gchar*
+greeter_secure_entry_buffer_get_text(GtkEntryBuffer* buffer,
+                                     gsize* n_bytes)
+{
+    GreeterSecureEntryBuffer* self = GREETER_SECURE_ENTRY_BUFFER(buffer);
+
+    if(n_bytes)
+        *n_bytes = self->text_bytes;
+    return self->text ? self->text : "";
+}
+
+static guint
+greeter_secure_entry_buffer_get_length(GtkEntryBuffer* buffer)
+{
+    return GREETER_SECURE_ENTRY_BUFFER(buffer)->text_chars;
+}
+
+static guint
+greeter_secure_entry_buffer_insert_text(GtkEntryBuffer* buffer,
+                                        guint position,
+                                        const gchar* chars,
+                                        guint n_chars)
+{
+    GreeterSecureEntryBuffer* self = GREETER_SECURE_ENTRY_BUFFER(buffer);
+    gsize n_bytes = g_utf8_offset_to_pointer(chars, n_chars) - chars;
+
+    /* Text is moved to new block instead of realloc(): old copy is wiped */
+    if(self->text_bytes + n_bytes + 1 > self->text_size)
+    {
+        gsize size = MAX(self->text_size, 64);
+        while(self->text_bytes + n_bytes + 1 > size)
+            size *= 2;
+
+        gchar* text = greeter_secure_alloc(size);
+        if(self->text)
+            memcpy(text, self->text, self->text_bytes + 1);
+        greeter_secure_free(self->text);
+        self->text = text;
+        self->text_size = size;
+    }
+
+    position = MIN(position, self->text_chars);
+    gsize at = g_utf8_offset_to_pointer(self->text, position) - self->text;
+    memmove(self->text + at + n_bytes, self->text + at, self->text_bytes - at);
+    memcpy(self->text + at, chars, n_bytes);
+
+    self->text_bytes += n_bytes;
+    self->text_chars += n_chars;
+    self->text[self->text_bytes] = '\0';
+
+    gtk_entry_buffer_emit_inserted_text(buffer, position, chars, n_chars);
+    return n_chars;
+}
+
+static guint
+greeter_secure_entry_buffer_delete_text(GtkEntryBuffer* buffer,
+                                        guint position,
+                                        guint n_chars)
+{
+    GreeterSecureEntryBuffer* self = GREETER_SECURE_ENTRY_BUFFER(buffer);
+
+    position = MIN(position, self->text_chars);
+    n_chars = MIN(n_chars, self->text_chars - position);
+    if(n_chars == 0)
+        return 0;
+
+    gsize start = g_utf8_offset_to_pointer(self->text, position) - self->text;
+    gsize end = g_utf8_offset_to_pointer(self->text, position + n_chars) - self->text;
+
+    memmove(self->text + start, self->text + end, self->text_bytes + 1 - end);
+    self->text_chars -= n_chars;
+    self->text_bytes -= end - start;
+    /* Tail still contains moved characters */
+    secure_wipe(self->text + self->text_bytes + 1, end - start);
+
+    gtk_entry_buffer_emit_deleted_text(buffer, position, n_chars);
+    return n_chars;
+}
@@ -0,0 +1,31 @@
+#ifndef GREETER_SECURE_H
+#define GREETER_SECURE_H
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* Locked memory for credentials: never swapped out, guarded by inaccessible pages, wiped on free.
+ * Covers greeter's own copies only: libraries (e.g. liblightdm sending responses) use their own memory. */
+gpointer greeter_secure_alloc                       (gsize size);
+void greeter_secure_free                            (gpointer mem);
+gsize greeter_secure_get_locked_bytes               (void);
+
+#define GREETER_SECURE_ENTRY_BUFFER_TYPE            (greeter_secure_entry_buffer_get_type())
+#define GREETER_SECURE_ENTRY_BUFFER(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), GREETER_SECURE_ENTRY_BUFFER_TYPE, GreeterSecureEntryBuffer))
+#define GREETER_SECURE_ENTRY_BUFFER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), GREETER_SECURE_ENTRY_BUFFER_TYPE, GreeterSecureEntryBufferClass))
+#define GREETER_IS_SECURE_ENTRY_BUFFER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), GREETER_SECURE_ENTRY_BUFFER_TYPE))
+#define GREETER_IS_SECURE_ENTRY_BUFFER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), GREETER_SECURE_ENTRY_BUFFER_TYPE))
+
+typedef struct _GreeterSecureEntryBuffer        GreeterSecureEntryBuffer;
+typedef struct _GreeterSecureEntryBufferClass   GreeterSecureEntryBufferClass;
+
+GType greeter_secure_entry_buffer_get_type(void) G_GNUC_CONST;
+
+/* GtkEntryBuffer keeping its text in secure memory */
+GtkEntryBuffer* greeter_secure_entry_buffer_new     (void);
+
+G_END_DECLS
+
+#endif // GREETER_SECURE_H
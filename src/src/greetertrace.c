@@ -0,0 +1,171 @@
+#include <unistd.h>
+
+#include "greetertrace.h"
+
+#ifndef GREETER_TRACE_DISABLED
+
+/* Protection from unbounded growth if something traces in a loop */
+#define TRACE_EVENTS_LIMIT  65536
+
+typedef struct
+{
+    const gchar* name;
+    /* 'B' or 'E', async: 'b' or 'e' */
+    gchar phase;
+    gint tid;
+    /* Microseconds, monotonic */
+    gint64 ts;
+} TraceEvent;
+
+static gint trace_enabled = FALSE;
+static GArray* trace_events = NULL;
+static gchar* trace_output = NULL;
+static gint trace_last_tid = 0;
+static GPrivate trace_tid;
+G_LOCK_DEFINE_STATIC(trace);
+
+static gint trace_get_tid                           (void);
+static void trace_add                               (const gchar* name,
+                                                     gchar phase);
+
+void
+greeter_trace_init(void)
+{
+    G_LOCK(trace);
+    if(!trace_events)
+        trace_events = g_array_sized_new(FALSE, FALSE, sizeof(TraceEvent), 256);
+    /* Calling thread gets first id and is named "main" */
+    trace_get_tid();
+    g_atomic_int_set(&trace_enabled, TRUE);
+    G_UNLOCK(trace);
+}
+
+void
+greeter_trace_set_output(const gchar* path)
+{
+    G_LOCK(trace);
+    g_free(trace_output);
+    trace_output = g_strdup(path);
+    if(!path)
+    {
+        g_atomic_int_set(&trace_enabled, FALSE);
+        if(trace_events)
+            g_array_free(trace_events, TRUE);
+        trace_events = NULL;
+    }
+    G_UNLOCK(trace);
+
+    if(path)
+        g_debug("[Trace] Startup trace will be written to %s", path);
+}
+
+void
+greeter_trace_save(void)
+{
+    if(!g_atomic_int_get(&trace_enabled))
+        return;
+
+    GString* json = g_string_new("{\"traceEvents\":[\n");
+    gint pid = getpid();
+    gint tid;
+    guint i;
+
+    G_LOCK(trace);
+    if(!trace_output || !trace_events)
+    {
+        G_UNLOCK(trace);
+        g_string_free(json, TRUE);
+        return;
+    }
+
+    for(tid = 1; tid <= trace_last_tid; ++tid)
+    {
+        gchar* thread_name = tid == 1 ? g_strdup("main") : g_strdup_printf("worker-%d", tid - 1);
+        g_string_append_printf(json, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                                     "\"args\":{\"name\":\"%s\"}},\n",
+                               pid, tid, thread_name);
+        g_free(thread_name);
+    }
+
+    for(i = 0; i < trace_events->len; ++i)
+    {
+        const TraceEvent* event = &g_array_index(trace_events, TraceEvent, i);
+        g_string_append_printf(json, "{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,"
+                                     "\"ts\":%" G_GINT64_FORMAT,
+                               event->name, event->phase, pid, event->tid, event->ts);
+        /* Async begin and end are matched by id */
+        if(g_ascii_islower(event->phase))
+            g_string_append_printf(json, ",\"id\":%u", g_str_hash(event->name));
+        g_string_append_printf(json, "}%s\n", i + 1 < trace_events->len ? "," : "");
+    }
+    gchar* path = g_strdup(trace_output);
+    guint count = trace_events->len;
+    G_UNLOCK(trace);
+
+    g_string_append(json, "]}\n");
+
+    GError* error = NULL;
+    if(g_file_set_contents(path, json->str, json->len, &error))
+        g_debug("[Trace] %u events written to %s", count, path);
+    else
+        g_warning("[Trace] Failed to write trace: %s", error->message);
+    g_clear_error(&error);
+    g_string_free(json, TRUE);
+    g_free(path);
+}
+
+void
+greeter_trace_begin(const gchar* name)
+{
+    if(g_atomic_int_get(&trace_enabled))
+        trace_add(name, 'B');
+}
+
+void
+greeter_trace_end(const gchar* name)
+{
+    if(g_atomic_int_get(&trace_enabled))
+        trace_add(name, 'E');
+}
+
+void
+greeter_trace_async_begin(const gchar* name)
+{
+    if(g_atomic_int_get(&trace_enabled))
+        trace_add(name, 'b');
+}
+
+void
+greeter_trace_async_end(const gchar* name)
+{
+    if(g_atomic_int_get(&trace_enabled))
+        trace_add(name, 'e');
+}
+
+static void
+trace_add(const gchar* name,
+          gchar phase)
+{
+    TraceEvent event = {name, phase, 0, g_get_monotonic_time()};
+
+    G_LOCK(trace);
+    event.tid = trace_get_tid();
+    if(trace_events && trace_events->len < TRACE_EVENTS_LIMIT)
+        g_array_append_val(trace_events, event);
+    G_UNLOCK(trace);
+}
+
+/* Small sequential ids instead of system ones: trace viewers sort threads by id. Called with lock held */
+static gint
+trace_get_tid(void)
+{
+    gint tid = GPOINTER_TO_INT(g_private_get(&trace_tid));
+    if(tid == 0)
+    {
+        tid = ++trace_last_tid;
+        g_private_set(&trace_tid, GINT_TO_POINTER(tid));
+    }
+    return tid;
+}
+
+#endif // GREETER_TRACE_DISABLED
@@ -0,0 +1,47 @@
+#ifndef GREETER_TRACE_H
+#define GREETER_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Startup timeline in Chrome trace-event format (chrome://tracing, ui.perfetto.dev).
+ * Spans are nestable, every thread has its own stack. Span names must be string literals.
+ * Build with -DGREETER_TRACE_DISABLED to compile tracing out completely. */
+#ifndef GREETER_TRACE_DISABLED
+
+/* Start recording, events are kept in memory until output is known */
+void greeter_trace_init                             (void);
+/* Set output file, NULL: stop recording and drop collected events */
+void greeter_trace_set_output                       (const gchar* path);
+/* Write collected events, recording continues */
+void greeter_trace_save                             (void);
+void greeter_trace_begin                            (const gchar* name);
+void greeter_trace_end                              (const gchar* name);
+/* Span that is not nested: may start and finish in different places, e.g. callbacks */
+void greeter_trace_async_begin                      (const gchar* name);
+void greeter_trace_async_end                        (const gchar* name);
+
+#define GREETER_TRACE_INIT()                        greeter_trace_init()
+#define GREETER_TRACE_SET_OUTPUT(path)              greeter_trace_set_output(path)
+#define GREETER_TRACE_SAVE()                        greeter_trace_save()
+#define GREETER_TRACE_BEGIN(name)                   greeter_trace_begin(name)
+#define GREETER_TRACE_END(name)                     greeter_trace_end(name)
+#define GREETER_TRACE_ASYNC_BEGIN(name)             greeter_trace_async_begin(name)
+#define GREETER_TRACE_ASYNC_END(name)               greeter_trace_async_end(name)
+
+#else
+
+#define GREETER_TRACE_INIT()                        G_STMT_START { } G_STMT_END
+#define GREETER_TRACE_SET_OUTPUT(path)              G_STMT_START { } G_STMT_END
+#define GREETER_TRACE_SAVE()                        G_STMT_START { } G_STMT_END
+#define GREETER_TRACE_BEGIN(name)                   G_STMT_START { } G_STMT_END
+#define GREETER_TRACE_END(name)                     G_STMT_START { } G_STMT_END
+#define GREETER_TRACE_ASYNC_BEGIN(name)             G_STMT_START { } G_STMT_END
+#define GREETER_TRACE_ASYNC_END(name)               G_STMT_START { } G_STMT_END
+
+#endif
+
+G_END_DECLS
+
+#endif // GREETER_TRACE_H
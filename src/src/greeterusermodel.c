@@ -0,0 +1,466 @@
+#include "greeterusermodel.h"
+
+typedef struct
+{
+    /* NULL for special entries */
+    LightDMUser* user;
+    gchar* name;
+    gchar* label;
+    /* Key in index, user name can be changed by LightDMUser */
+    gchar* key;
+    /* Position in rows */
+    guint index;
+} UserModelRow;
+
+struct _GreeterUserModel
+{
+    GObject parent_instance;
+    /* <UserModelRow*>, users first, then special entries */
+    GPtrArray* rows;
+    guint n_users;
+    /* <gchar* key, UserModelRow*>, keys are owned by rows */
+    GHashTable* index;
+    gint stamp;
+};
+
+struct _GreeterUserModelClass
+{
+    GObjectClass parent_class;
+};
+
+static void greeter_user_model_tree_model_init      (GtkTreeModelIface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(GreeterUserModel, greeter_user_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, greeter_user_model_tree_model_init));
+
+static void greeter_user_model_finalize             (GObject* object);
+
+static GtkTreeModelFlags user_model_get_flags       (GtkTreeModel* tree_model);
+static gint user_model_get_n_columns                (GtkTreeModel* tree_model);
+static GType user_model_get_column_type             (GtkTreeModel* tree_model,
+                                                     gint index);
+static gboolean user_model_get_iter                 (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter,
+                                                     GtkTreePath* path);
+static GtkTreePath* user_model_get_path             (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter);
+static void user_model_get_value                    (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter,
+                                                     gint column,
+                                                     GValue* value);
+static gboolean user_model_iter_next                (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter);
+static gboolean user_model_iter_previous            (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter);
+static gboolean user_model_iter_children            (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter,
+                                                     GtkTreeIter* parent);
+static gboolean user_model_iter_has_child           (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter);
+static gint user_model_iter_n_children              (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter);
+static gboolean user_model_iter_nth_child           (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter,
+                                                     GtkTreeIter* parent,
+                                                     gint n);
+static gboolean user_model_iter_parent              (GtkTreeModel* tree_model,
+                                                     GtkTreeIter* iter,
+                                                     GtkTreeIter* child);
+
+static void user_model_row_free                     (UserModelRow* row);
+static void user_model_insert_row                   (GreeterUserModel* model,
+                                                     guint index,
+                                                     UserModelRow* row,
+                                                     GtkTreeIter* iter);
+static void user_model_update_indices               (GreeterUserModel* model,
+                                                     guint from);
+static UserModelRow* user_model_get_row             (GreeterUserModel* model,
+                                                     GtkTreeIter* iter);
+static void user_model_set_iter                     (GreeterUserModel* model,
+                                                     GtkTreeIter* iter,
+                                                     guint index);
+
+/* Implementation */
+
+static void
+greeter_user_model_class_init(GreeterUserModelClass* klass)
+{
+    GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    gobject_class->finalize = greeter_user_model_finalize;
+}
+
+static void
+greeter_user_model_tree_model_init(GtkTreeModelIface* iface)
+{
+    iface->get_flags = user_model_get_flags;
+    iface->get_n_columns = user_model_get_n_columns;
+    iface->get_column_type = user_model_get_column_type;
+    iface->get_iter = user_model_get_iter;
+    iface->get_path = user_model_get_path;
+    iface->get_value = user_model_get_value;
+    iface->iter_next = user_model_iter_next;
+    iface->iter_previous = user_model_iter_previous;
+    iface->iter_children = user_model_iter_children;
+    iface->iter_has_child = user_model_iter_has_child;
+    iface->iter_n_children = user_model_iter_n_children;
+    iface->iter_nth_child = user_model_iter_nth_child;
+    iface->iter_parent = user_model_iter_parent;
+}
+
+static void
+greeter_user_model_init(GreeterUserModel* self)
+{
+    self->rows = g_ptr_array_new_with_free_func((GDestroyNotify)user_model_row_free);
+    self->n_users = 0;
+    self->index = g_hash_table_new(g_str_hash, g_str_equal);
+    self->stamp = g_random_int_range(1, G_MAXINT32);
+}
+
+static void
+greeter_user_model_finalize(GObject* object)
+{
+    GreeterUserModel* self = GREETER_USER_MODEL(object);
+
+    g_hash_table_unref(self->index);
+    g_ptr_array_unref(self->rows);
+
+    G_OBJECT_CLASS(greeter_user_model_parent_class)->finalize(object);
+}
+
+GreeterUserModel*
+greeter_user_model_new(void)
+{
+    return GREETER_USER_MODEL(g_object_new(GREETER_USER_MODEL_TYPE, NULL));
+}
+
+void
+greeter_user_model_append_user(GreeterUserModel* model,
+                               LightDMUser* user,
+                               GtkTreeIter* iter)
+{
+    g_return_if_fail(GREETER_IS_USER_MODEL(model));
+    g_return_if_fail(LIGHTDM_IS_USER(user));
+
+    UserModelRow* row = g_new0(UserModelRow, 1);
+    row->user = g_object_ref(user);
+    row->key = g_strdup(lightdm_user_get_name(user));
+    user_model_insert_row(model, model->n_users++, row, iter);
+}
+
+void
+greeter_user_model_append_special(GreeterUserModel* model,
+                                  const gchar* name,
+                                  const gchar* label,
+                                  GtkTreeIter* iter)
+{
+    g_return_if_fail(GREETER_IS_USER_MODEL(model));
+    g_return_if_fail(name != NULL);
+
+    UserModelRow* row = g_new0(UserModelRow, 1);
+    row->name = g_strdup(name);
+    row->label = g_strdup(label);
+    row->key = g_strdup(name);
+    user_model_insert_row(model, model->rows->len, row, iter);
+}
+
+void
+greeter_user_model_remove(GreeterUserModel* model,
+                          GtkTreeIter* iter)
+{
+    g_return_if_fail(GREETER_IS_USER_MODEL(model));
+
+    UserModelRow* row = user_model_get_row(model, iter);
+    g_return_if_fail(row != NULL);
+
+    guint index = row->index;
+    if(row->user)
+        model->n_users--;
+    if(g_hash_table_lookup(model->index, row->key) == row)
+        g_hash_table_remove(model->index, row->key);
+    g_ptr_array_remove_index(model->rows, index);
+    user_model_update_indices(model, index);
+
+    GtkTreePath* path = gtk_tree_path_new_from_indices(index, -1);
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+    gtk_tree_path_free(path);
+}
+
+void
+greeter_user_model_user_changed(GreeterUserModel* model,
+                                GtkTreeIter* iter)
+{
+    g_return_if_fail(GREETER_IS_USER_MODEL(model));
+    g_return_if_fail(user_model_get_row(model, iter) != NULL);
+
+    GtkTreePath* path = user_model_get_path(GTK_TREE_MODEL(model), iter);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, iter);
+    gtk_tree_path_free(path);
+}
+
+gboolean
+greeter_user_model_find(GreeterUserModel* model,
+                        const gchar* name,
+                        GtkTreeIter* iter)
+{
+    g_return_val_if_fail(GREETER_IS_USER_MODEL(model), FALSE);
+    g_return_val_if_fail(iter != NULL, FALSE);
+
+    UserModelRow* row = name ? g_hash_table_lookup(model->index, name) : NULL;
+    if(!row)
+        return FALSE;
+
+    user_model_set_iter(model, iter, row->index);
+    return TRUE;
+}
+
+const gchar*
+greeter_user_model_get_name(GreeterUserModel* model,
+                            GtkTreeIter* iter)
+{
+    g_return_val_if_fail(GREETER_IS_USER_MODEL(model), NULL);
+
+    UserModelRow* row = user_model_get_row(model, iter);
+    if(!row)
+        return NULL;
+    return row->user ? lightdm_user_get_name(row->user) : row->name;
+}
+
+const gchar*
+greeter_user_model_get_label(GreeterUserModel* model,
+                             GtkTreeIter* iter)
+{
+    g_return_val_if_fail(GREETER_IS_USER_MODEL(model), NULL);
+
+    UserModelRow* row = user_model_get_row(model, iter);
+    if(!row)
+        return NULL;
+    return row->user ? lightdm_user_get_display_name(row->user) : row->label;
+}
+
+/* GtkTreeModel implementation */
+
+static GtkTreeModelFlags
+user_model_get_flags(GtkTreeModel* tree_model)
+{
+    return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+user_model_get_n_columns(GtkTreeModel* tree_model)
+{
+    return GREETER_USER_MODEL_N_COLUMNS;
+}
+
+static GType
+user_model_get_column_type(GtkTreeModel* tree_model,
+                           gint index)
+{
+    switch(index)
+    {
+        case GREETER_USER_MODEL_COLUMN_NAME:
+        case GREETER_USER_MODEL_COLUMN_LABEL:
+            return G_TYPE_STRING;
+        case GREETER_USER_MODEL_COLUMN_WEIGHT:
+            return G_TYPE_INT;
+        default:
+            return G_TYPE_INVALID;
+    }
+}
+
+static gboolean
+user_model_get_iter(GtkTreeModel* tree_model,
+                    GtkTreeIter* iter,
+                    GtkTreePath* path)
+{
+    GreeterUserModel* model = GREETER_USER_MODEL(tree_model);
+
+    if(gtk_tree_path_get_depth(path) != 1)
+        return FALSE;
+
+    gint index = gtk_tree_path_get_indices(path)[0];
+    if(index < 0 || (guint)index >= model->rows->len)
+        return FALSE;
+
+    user_model_set_iter(model, iter, index);
+    return TRUE;
+}
+
+static GtkTreePath*
+user_model_get_path(GtkTreeModel* tree_model,
+                    GtkTreeIter* iter)
+{
+    g_return_val_if_fail(user_model_get_row(GREETER_USER_MODEL(tree_model), iter) != NULL, NULL);
+    return gtk_tree_path_new_from_indices(GPOINTER_TO_UINT(iter->user_data), -1);
+}
+
+static void
+user_model_get_value(GtkTreeModel* tree_model,
+                     GtkTreeIter* iter,
+                     gint column,
+                     GValue* value)
+{
+    GreeterUserModel* model = GREETER_USER_MODEL(tree_model);
+    UserModelRow* row = user_model_get_row(model, iter);
+
+    g_return_if_fail(row != NULL);
+
+    g_value_init(value, user_model_get_column_type(tree_model, column));
+    switch(column)
+    {
+        case GREETER_USER_MODEL_COLUMN_NAME:
+            g_value_set_string(value, row->user ? lightdm_user_get_name(row->user) : row->name);
+            break;
+        case GREETER_USER_MODEL_COLUMN_LABEL:
+            g_value_set_string(value, row->user ? lightdm_user_get_display_name(row->user) : row->label);
+            break;
+        case GREETER_USER_MODEL_COLUMN_WEIGHT:
+            g_value_set_int(value, row->user && lightdm_user_get_logged_in(row->user) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL);
+            break;
+    }
+}
+
+static gboolean
+user_model_iter_next(GtkTreeModel* tree_model,
+                     GtkTreeIter* iter)
+{
+    GreeterUserModel* model = GREETER_USER_MODEL(tree_model);
+    guint index = GPOINTER_TO_UINT(iter->user_data) + 1;
+
+    if(iter->stamp != model->stamp || index >= model->rows->len)
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    user_model_set_iter(model, iter, index);
+    return TRUE;
+}
+
+static gboolean
+user_model_iter_previous(GtkTreeModel* tree_model,
+                         GtkTreeIter* iter)
+{
+    GreeterUserModel* model = GREETER_USER_MODEL(tree_model);
+    guint index = GPOINTER_TO_UINT(iter->user_data);
+
+    if(iter->stamp != model->stamp || index == 0 || index > model->rows->len)
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    user_model_set_iter(model, iter, index - 1);
+    return TRUE;
+}
+
+static gboolean
+user_model_iter_children(GtkTreeModel* tree_model,
+                         GtkTreeIter* iter,
+                         GtkTreeIter* parent)
+{
+    return user_model_iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean
+user_model_iter_has_child(GtkTreeModel* tree_model,
+                          GtkTreeIter* iter)
+{
+    return FALSE;
+}
+
+static gint
+user_model_iter_n_children(GtkTreeModel* tree_model,
+                           GtkTreeIter* iter)
+{
+    return iter ? 0 : (gint)GREETER_USER_MODEL(tree_model)->rows->len;
+}
+
+static gboolean
+user_model_iter_nth_child(GtkTreeModel* tree_model,
+                          GtkTreeIter* iter,
+                          GtkTreeIter* parent,
+                          gint n)
+{
+    GreeterUserModel* model = GREETER_USER_MODEL(tree_model);
+
+    if(parent || n < 0 || (guint)n >= model->rows->len)
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    user_model_set_iter(model, iter, n);
+    return TRUE;
+}
+
+static gboolean
+user_model_iter_parent(GtkTreeModel* tree_model,
+                       GtkTreeIter* iter,
+                       GtkTreeIter* child)
+{
+    iter->stamp = 0;
+    return FALSE;
+}
+
+/* Rows */
+
+static void
+user_model_row_free(UserModelRow* row)
+{
+    if(row->user)
+        g_object_unref(row->user);
+    g_free(row->name);
+    g_free(row->label);
+    g_free(row->key);
+    g_free(row);
+}
+
+static void
+user_model_insert_row(GreeterUserModel* model,
+                      guint index,
+                      UserModelRow* row,
+                      GtkTreeIter* iter)
+{
+    GtkTreeIter row_iter;
+
+    g_ptr_array_insert(model->rows, index, row);
+    user_model_update_indices(model, index);
+    /* Names are expected to be unique, first row wins */
+    if(!g_hash_table_contains(model->index, row->key))
+        g_hash_table_insert(model->index, row->key, row);
+    user_model_set_iter(model, &row_iter, index);
+
+    GtkTreePath* path = gtk_tree_path_new_from_indices(index, -1);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &row_iter);
+    gtk_tree_path_free(path);
+
+    if(iter)
+        *iter = row_iter;
+}
+
+/* Users are usually added before special entries and removed rarely: only few rows are updated */
+static void
+user_model_update_indices(GreeterUserModel* model,
+                          guint from)
+{
+    guint i;
+    for(i = from; i < model->rows->len; ++i)
+        ((UserModelRow*)g_ptr_array_index(model->rows, i))->index = i;
+}
+
+static UserModelRow*
+user_model_get_row(GreeterUserModel* model,
+                   GtkTreeIter* iter)
+{
+    if(!iter || iter->stamp != model->stamp || GPOINTER_TO_UINT(iter->user_data) >= model->rows->len)
+        return NULL;
+    return g_ptr_array_index(model->rows, GPOINTER_TO_UINT(iter->user_data));
+}
+
+static void
+user_model_set_iter(GreeterUserModel* model,
+                    GtkTreeIter* iter,
+                    guint index)
+{
+    iter->stamp = model->stamp;
+    iter->user_data = GUINT_TO_POINTER(index);
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
@@ -0,0 +1,57 @@
+#ifndef GREETER_USER_MODEL_H
+#define GREETER_USER_MODEL_H
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+#include <lightdm.h>
+
+G_BEGIN_DECLS
+
+#define GREETER_USER_MODEL_TYPE             (greeter_user_model_get_type())
+#define GREETER_USER_MODEL(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GREETER_USER_MODEL_TYPE, GreeterUserModel))
+#define GREETER_USER_MODEL_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GREETER_USER_MODEL_TYPE, GreeterUserModelClass))
+#define GREETER_IS_USER_MODEL(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GREETER_USER_MODEL_TYPE))
+#define GREETER_IS_USER_MODEL_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GREETER_USER_MODEL_TYPE))
+
+typedef struct _GreeterUserModel            GreeterUserModel;
+typedef struct _GreeterUserModelClass       GreeterUserModelClass;
+
+/* Same columns as GtkListStore used before */
+enum
+{
+    GREETER_USER_MODEL_COLUMN_NAME,         /* gchararray, user name or "*guest", "*other" */
+    GREETER_USER_MODEL_COLUMN_LABEL,        /* gchararray */
+    GREETER_USER_MODEL_COLUMN_WEIGHT,       /* gint, PangoWeight */
+    GREETER_USER_MODEL_N_COLUMNS
+};
+
+GType greeter_user_model_get_type(void) G_GNUC_CONST;
+
+/* List model of users: rows only keep LightDMUser reference, values are read from it when requested.
+ * Special entries are always kept after users. */
+GreeterUserModel* greeter_user_model_new            (void);
+void greeter_user_model_append_user                 (GreeterUserModel* model,
+                                                     LightDMUser* user,
+                                                     GtkTreeIter* iter);
+void greeter_user_model_append_special              (GreeterUserModel* model,
+                                                     const gchar* name,
+                                                     const gchar* label,
+                                                     GtkTreeIter* iter);
+void greeter_user_model_remove                      (GreeterUserModel* model,
+                                                     GtkTreeIter* iter);
+/* Lookup by user name (or special entry name) using index, no rows are visited */
+gboolean greeter_user_model_find                    (GreeterUserModel* model,
+                                                     const gchar* name,
+                                                     GtkTreeIter* iter);
+/* Emits "row-changed" after user properties were changed */
+void greeter_user_model_user_changed                (GreeterUserModel* model,
+                                                     GtkTreeIter* iter);
+/* Returned string is owned by model, no copy is made */
+const gchar* greeter_user_model_get_name            (GreeterUserModel* model,
+                                                     GtkTreeIter* iter);
+const gchar* greeter_user_model_get_label           (GreeterUserModel* model,
+                                                     GtkTreeIter* iter);
+
+G_END_DECLS
+
+#endif // GREETER_USER_MODEL_H
@@ -0,0 +1,688 @@
+#include <string.h>
+
+#include "greeteruserpicker.h"
+#include "greeterusermodel.h"
+
+struct _GreeterUserPicker
+{
+    GtkToggleButton parent_instance;
+    GtkTreeModel* model;
+    GtkTreeRowReference* active;
+    GtkWidget* label;
+    /* Popup widgets are created on first use */
+    GtkWidget* popover;
+    GtkWidget* search_entry;
+    GtkWidget* tree_view;
+    GtkWidget* scrolled;
+    gint row_height;
+    /* Filtered view of model, only exists while search text is not empty */
+    GtkTreeModel* filter;
+    /* Casefolded search text */
+    gchar* search_key;
+    /* Closed popup list is detached from model, see greeter_user_picker_freeze_view() */
+    gboolean view_frozen;
+};
+
+struct _GreeterUserPickerClass
+{
+    GtkToggleButtonClass parent_class;
+};
+
+enum
+{
+    USER_PICKER_SIGNAL_CHANGED,
+    USER_PICKER_SIGNAL_LAST
+};
+
+static guint user_picker_signals[USER_PICKER_SIGNAL_LAST] = {0};
+
+/* Popup list height, rows */
+static const gint USER_PICKER_VISIBLE_ROWS          = 10;
+
+G_DEFINE_TYPE(GreeterUserPicker, greeter_user_picker, GTK_TYPE_TOGGLE_BUTTON);
+
+static void greeter_user_picker_dispose             (GObject* object);
+static void greeter_user_picker_finalize            (GObject* object);
+static gboolean greeter_user_picker_key_press_event (GtkWidget* widget,
+                                                     GdkEventKey* event);
+static void greeter_user_picker_toggled             (GtkToggleButton* button);
+
+static void user_picker_build_popup                 (GreeterUserPicker* self);
+static void user_picker_update_label                (GreeterUserPicker* self);
+static void user_picker_update_view_model           (GreeterUserPicker* self);
+static void user_picker_set_search_text             (GreeterUserPicker* self,
+                                                     const gchar* text);
+static void user_picker_move_active                 (GreeterUserPicker* self,
+                                                     gboolean forward);
+static void user_picker_move_cursor                 (GreeterUserPicker* self,
+                                                     gint delta);
+static gboolean user_picker_text_matches            (const gchar* text,
+                                                     const gchar* key);
+
+static gboolean user_picker_filter_visible_cb       (GtkTreeModel* model,
+                                                     GtkTreeIter* iter,
+                                                     GreeterUserPicker* self);
+static void user_picker_model_row_changed_cb        (GtkTreeModel* model,
+                                                     GtkTreePath* path,
+                                                     GtkTreeIter* iter,
+                                                     GreeterUserPicker* self);
+static void user_picker_model_row_deleted_cb        (GtkTreeModel* model,
+                                                     GtkTreePath* path,
+                                                     GreeterUserPicker* self);
+static void user_picker_row_activated_cb            (GtkTreeView* tree_view,
+                                                     GtkTreePath* path,
+                                                     GtkTreeViewColumn* column,
+                                                     GreeterUserPicker* self);
+static void user_picker_search_changed_cb           (GtkSearchEntry* entry,
+                                                     GreeterUserPicker* self);
+static void user_picker_search_activate_cb          (GtkEntry* entry,
+                                                     GreeterUserPicker* self);
+static gboolean user_picker_search_key_press_cb     (GtkWidget* widget,
+                                                     GdkEventKey* event,
+                                                     GreeterUserPicker* self);
+static void user_picker_popover_closed_cb           (GtkPopover* popover,
+                                                     GreeterUserPicker* self);
+
+/* Implementation */
+
+static void
+greeter_user_picker_class_init(GreeterUserPickerClass* klass)
+{
+    GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    GtkWidgetClass* widget_class = GTK_WIDGET_CLASS(klass);
+    GtkToggleButtonClass* toggle_class = GTK_TOGGLE_BUTTON_CLASS(klass);
+
+    gobject_class->dispose = greeter_user_picker_dispose;
+    gobject_class->finalize = greeter_user_picker_finalize;
+    widget_class->key_press_event = greeter_user_picker_key_press_event;
+    toggle_class->toggled = greeter_user_picker_toggled;
+
+    user_picker_signals[USER_PICKER_SIGNAL_CHANGED] =
+                            g_signal_new("changed",
+                                         G_TYPE_FROM_CLASS(gobject_class),
+                                         G_SIGNAL_RUN_LAST,
+                                         0, /* class_offset */
+                                         NULL /* accumulator */, NULL /* accu_data */,
+                                         g_cclosure_marshal_VOID__VOID,
+                                         G_TYPE_NONE, 0);
+}
+
+static void
+greeter_user_picker_init(GreeterUserPicker* self)
+{
+    GtkWidget* box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    GtkWidget* arrow = gtk_image_new_from_icon_name("pan-down-symbolic", GTK_ICON_SIZE_BUTTON);
+
+    self->model = NULL;
+    self->active = NULL;
+    self->popover = NULL;
+    self->search_entry = NULL;
+    self->tree_view = NULL;
+    self->scrolled = NULL;
+    self->row_height = 0;
+    self->filter = NULL;
+    self->search_key = NULL;
+    self->view_frozen = FALSE;
+
+    self->label = gtk_label_new(NULL);
+    gtk_widget_set_halign(self->label, GTK_ALIGN_START);
+    gtk_label_set_ellipsize(GTK_LABEL(self->label), PANGO_ELLIPSIZE_END);
+    gtk_box_pack_start(GTK_BOX(box), self->label, TRUE, TRUE, 0);
+    gtk_box_pack_end(GTK_BOX(box), arrow, FALSE, FALSE, 0);
+    gtk_widget_show_all(box);
+    gtk_container_add(GTK_CONTAINER(self), box);
+
+    /* Same look as GtkComboBox button */
+    gtk_style_context_add_class(gtk_widget_get_style_context(GTK_WIDGET(self)), "combo");
+}
+
+static void
+greeter_user_picker_dispose(GObject* object)
+{
+    GreeterUserPicker* self = GREETER_USER_PICKER(object);
+
+    greeter_user_picker_set_model(self, NULL);
+    if(self->popover)
+    {
+        gtk_widget_destroy(self->popover);
+        self->popover = NULL;
+        self->search_entry = NULL;
+        self->tree_view = NULL;
+        self->scrolled = NULL;
+    }
+
+    G_OBJECT_CLASS(greeter_user_picker_parent_class)->dispose(object);
+}
+
+static void
+greeter_user_picker_finalize(GObject* object)
+{
+    GreeterUserPicker* self = GREETER_USER_PICKER(object);
+
+    g_free(self->search_key);
+
+    G_OBJECT_CLASS(greeter_user_picker_parent_class)->finalize(object);
+}
+
+GtkWidget*
+greeter_user_picker_new(void)
+{
+    return GTK_WIDGET(g_object_new(GREETER_USER_PICKER_TYPE, NULL));
+}
+
+void
+greeter_user_picker_set_model(GreeterUserPicker* picker,
+                              GtkTreeModel* model)
+{
+    g_return_if_fail(GREETER_IS_USER_PICKER(picker));
+    g_return_if_fail(model == NULL || GTK_IS_TREE_MODEL(model));
+
+    if(picker->model == model)
+        return;
+
+    if(picker->model)
+    {
+        g_signal_handlers_disconnect_by_data(picker->model, picker);
+        g_clear_pointer(&picker->active, gtk_tree_row_reference_free);
+        g_clear_object(&picker->model);
+    }
+
+    if(model)
+    {
+        picker->model = g_object_ref(model);
+        g_signal_connect(model, "row-changed", G_CALLBACK(user_picker_model_row_changed_cb), picker);
+        g_signal_connect(model, "row-deleted", G_CALLBACK(user_picker_model_row_deleted_cb), picker);
+    }
+
+    user_picker_update_view_model(picker);
+    user_picker_update_label(picker);
+}
+
+void
+greeter_user_picker_freeze_view(GreeterUserPicker* picker)
+{
+    g_return_if_fail(GREETER_IS_USER_PICKER(picker));
+
+    /* Visible list keeps its model: cursor and scroll position must survive changes */
+    if(picker->view_frozen || !picker->tree_view || gtk_widget_get_visible(picker->popover))
+        return;
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(picker->tree_view), NULL);
+    g_clear_object(&picker->filter);
+    picker->view_frozen = TRUE;
+}
+
+void
+greeter_user_picker_thaw_view(GreeterUserPicker* picker)
+{
+    g_return_if_fail(GREETER_IS_USER_PICKER(picker));
+
+    if(picker->view_frozen)
+        user_picker_update_view_model(picker);
+}
+
+GtkTreeModel*
+greeter_user_picker_get_model(GreeterUserPicker* picker)
+{
+    g_return_val_if_fail(GREETER_IS_USER_PICKER(picker), NULL);
+    return picker->model;
+}
+
+gboolean
+greeter_user_picker_get_active_iter(GreeterUserPicker* picker,
+                                    GtkTreeIter* iter)
+{
+    g_return_val_if_fail(GREETER_IS_USER_PICKER(picker), FALSE);
+    g_return_val_if_fail(iter != NULL, FALSE);
+
+    if(!picker->active || !gtk_tree_row_reference_valid(picker->active))
+        return FALSE;
+
+    GtkTreePath* path = gtk_tree_row_reference_get_path(picker->active);
+    gboolean result = gtk_tree_model_get_iter(picker->model, iter, path);
+    gtk_tree_path_free(path);
+    return result;
+}
+
+void
+greeter_user_picker_set_active_iter(GreeterUserPicker* picker,
+                                    GtkTreeIter* iter)
+{
+    g_return_if_fail(GREETER_IS_USER_PICKER(picker));
+    g_return_if_fail(iter == NULL || picker->model != NULL);
+
+    GtkTreePath* path = iter ? gtk_tree_model_get_path(picker->model, iter) : NULL;
+    GtkTreePath* active_path = picker->active ? gtk_tree_row_reference_get_path(picker->active) : NULL;
+    gboolean same = path && active_path ? gtk_tree_path_compare(path, active_path) == 0 : path == active_path;
+
+    gtk_tree_path_free(active_path);
+    if(same)
+    {
+        gtk_tree_path_free(path);
+        return;
+    }
+
+    g_clear_pointer(&picker->active, gtk_tree_row_reference_free);
+    if(path)
+    {
+        picker->active = gtk_tree_row_reference_new(picker->model, path);
+        gtk_tree_path_free(path);
+    }
+
+    user_picker_update_label(picker);
+    g_signal_emit(picker, user_picker_signals[USER_PICKER_SIGNAL_CHANGED], 0);
+}
+
+void
+greeter_user_picker_popup(GreeterUserPicker* picker,
+                          const gchar* search_text)
+{
+    g_return_if_fail(GREETER_IS_USER_PICKER(picker));
+
+    if(!picker->popover)
+        user_picker_build_popup(picker);
+
+    gtk_entry_set_text(GTK_ENTRY(picker->search_entry), search_text ? search_text : "");
+    gtk_editable_set_position(GTK_EDITABLE(picker->search_entry), -1);
+    g_free(picker->search_key);
+    picker->search_key = search_text && *search_text ? g_utf8_casefold(search_text, -1) : NULL;
+    user_picker_update_view_model(picker);
+
+    /* Popup size does not depend on search results, list does not jump while typing */
+    gint n_rows = picker->model ? gtk_tree_model_iter_n_children(picker->model, NULL) : 0;
+    gtk_widget_set_size_request(picker->scrolled, gtk_widget_get_allocated_width(GTK_WIDGET(picker)),
+                                CLAMP(n_rows, 1, USER_PICKER_VISIBLE_ROWS)*picker->row_height);
+
+    gtk_widget_show(picker->popover);
+    gtk_widget_grab_focus(picker->search_entry);
+    /* Popover is visible already: toggled() does nothing */
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(picker), TRUE);
+}
+
+void
+greeter_user_picker_popdown(GreeterUserPicker* picker)
+{
+    g_return_if_fail(GREETER_IS_USER_PICKER(picker));
+
+    if(picker->popover)
+        gtk_widget_hide(picker->popover);
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(picker), FALSE);
+}
+
+static gboolean
+greeter_user_picker_key_press_event(GtkWidget* widget,
+                                    GdkEventKey* event)
+{
+    GreeterUserPicker* self = GREETER_USER_PICKER(widget);
+    GdkModifierType modifiers = event->state & gtk_accelerator_get_default_mod_mask();
+    gunichar ch = gdk_keyval_to_unicode(event->keyval);
+
+    if(modifiers == 0 && (event->keyval == GDK_KEY_Up || event->keyval == GDK_KEY_KP_Up))
+    {
+        user_picker_move_active(self, FALSE);
+        return TRUE;
+    }
+    if(modifiers == 0 && (event->keyval == GDK_KEY_Down || event->keyval == GDK_KEY_KP_Down))
+    {
+        user_picker_move_active(self, TRUE);
+        return TRUE;
+    }
+    if(modifiers == GDK_MOD1_MASK && (event->keyval == GDK_KEY_Down || event->keyval == GDK_KEY_KP_Down))
+    {
+        greeter_user_picker_popup(self, NULL);
+        return TRUE;
+    }
+    /* Type-ahead: first character goes to search entry */
+    if((modifiers & ~GDK_SHIFT_MASK) == 0 && ch && g_unichar_isgraph(ch))
+    {
+        gchar text[8] = {0};
+        g_unichar_to_utf8(ch, text);
+        greeter_user_picker_popup(self, text);
+        return TRUE;
+    }
+
+    return GTK_WIDGET_CLASS(greeter_user_picker_parent_class)->key_press_event(widget, event);
+}
+
+static void
+greeter_user_picker_toggled(GtkToggleButton* button)
+{
+    GreeterUserPicker* self = GREETER_USER_PICKER(button);
+
+    if(gtk_toggle_button_get_active(button))
+    {
+        if(!self->popover || !gtk_widget_get_visible(self->popover))
+            greeter_user_picker_popup(self, NULL);
+    }
+    else if(self->popover && gtk_widget_get_visible(self->popover))
+        gtk_widget_hide(self->popover);
+
+    if(GTK_TOGGLE_BUTTON_CLASS(greeter_user_picker_parent_class)->toggled)
+        GTK_TOGGLE_BUTTON_CLASS(greeter_user_picker_parent_class)->toggled(button);
+}
+
+/* Popup */
+
+static void
+user_picker_build_popup(GreeterUserPicker* self)
+{
+    GtkWidget* box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
+    GtkCellRenderer* renderer = gtk_cell_renderer_text_new();
+    GtkTreeViewColumn* column;
+    gint separator = 0;
+
+    self->popover = gtk_popover_new(GTK_WIDGET(self));
+    gtk_popover_set_position(GTK_POPOVER(self->popover), GTK_POS_BOTTOM);
+    g_signal_connect(self->popover, "closed", G_CALLBACK(user_picker_popover_closed_cb), self);
+
+    self->search_entry = gtk_search_entry_new();
+    g_signal_connect(self->search_entry, "search-changed", G_CALLBACK(user_picker_search_changed_cb), self);
+    g_signal_connect(self->search_entry, "activate", G_CALLBACK(user_picker_search_activate_cb), self);
+    g_signal_connect(self->search_entry, "key-press-event", G_CALLBACK(user_picker_search_key_press_cb), self);
+
+    /* Fixed height rows: only visible rows are measured and rendered */
+    g_object_set(renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+    gtk_cell_renderer_text_set_fixed_height_from_font(GTK_CELL_RENDERER_TEXT(renderer), 1);
+    column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
+                                                      "text", GREETER_USER_MODEL_COLUMN_LABEL,
+                                                      "weight", GREETER_USER_MODEL_COLUMN_WEIGHT,
+                                                      NULL);
+    gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_expand(column, TRUE);
+
+    self->tree_view = gtk_tree_view_new();
+    gtk_tree_view_append_column(GTK_TREE_VIEW(self->tree_view), column);
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(self->tree_view), TRUE);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(self->tree_view), FALSE);
+    gtk_tree_view_set_enable_search(GTK_TREE_VIEW(self->tree_view), FALSE);
+    gtk_tree_view_set_activate_on_single_click(GTK_TREE_VIEW(self->tree_view), TRUE);
+    g_signal_connect(self->tree_view, "row-activated", G_CALLBACK(user_picker_row_activated_cb), self);
+
+    gtk_cell_renderer_get_preferred_height(renderer, self->tree_view, &self->row_height, NULL);
+    gtk_widget_style_get(self->tree_view, "vertical-separator", &separator, NULL);
+    self->row_height += separator;
+
+    self->scrolled = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(self->scrolled), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(self->scrolled), GTK_SHADOW_IN);
+    gtk_container_add(GTK_CONTAINER(self->scrolled), self->tree_view);
+
+    gtk_container_set_border_width(GTK_CONTAINER(box), 6);
+    gtk_box_pack_start(GTK_BOX(box), self->search_entry, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(box), self->scrolled, TRUE, TRUE, 0);
+    gtk_widget_show_all(box);
+    gtk_container_add(GTK_CONTAINER(self->popover), box);
+
+    user_picker_update_view_model(self);
+}
+
+static void
+user_picker_update_label(GreeterUserPicker* self)
+{
+    GtkTreeIter iter;
+    gchar* text = NULL;
+    gint weight = PANGO_WEIGHT_NORMAL;
+
+    if(greeter_user_picker_get_active_iter(self, &iter))
+        gtk_tree_model_get(self->model, &iter,
+                           GREETER_USER_MODEL_COLUMN_LABEL, &text,
+                           GREETER_USER_MODEL_COLUMN_WEIGHT, &weight,
+                           -1);
+
+    PangoAttrList* attrs = pango_attr_list_new();
+    pango_attr_list_insert(attrs, pango_attr_weight_new(weight));
+    gtk_label_set_attributes(GTK_LABEL(self->label), attrs);
+    pango_attr_list_unref(attrs);
+
+    gtk_label_set_text(GTK_LABEL(self->label), text ? text : "");
+    g_free(text);
+}
+
+/* Sets model (or its filtered view) to popup list and places cursor */
+static void
+user_picker_update_view_model(GreeterUserPicker* self)
+{
+    GtkTreePath* path = NULL;
+    GtkTreeIter iter;
+
+    if(!self->tree_view)
+        return;
+
+    self->view_frozen = FALSE;
+    g_clear_object(&self->filter);
+    if(self->model && self->search_key)
+    {
+        self->filter = gtk_tree_model_filter_new(self->model, NULL);
+        gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(self->filter),
+                                               (GtkTreeModelFilterVisibleFunc)user_picker_filter_visible_cb,
+                                               self, NULL);
+    }
+    gtk_tree_view_set_model(GTK_TREE_VIEW(self->tree_view), self->filter ? self->filter : self->model);
+
+    if(self->filter)
+    {
+        if(gtk_tree_model_get_iter_first(self->filter, &iter))
+            path = gtk_tree_model_get_path(self->filter, &iter);
+    }
+    else if(self->active)
+        path = gtk_tree_row_reference_get_path(self->active);
+
+    if(path)
+    {
+        gtk_tree_view_set_cursor(GTK_TREE_VIEW(self->tree_view), path, NULL, FALSE);
+        gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(self->tree_view), path, NULL, TRUE, 0.5, 0.0);
+        gtk_tree_path_free(path);
+    }
+}
+
+static void
+user_picker_set_search_text(GreeterUserPicker* self,
+                            const gchar* text)
+{
+    gchar* key = text && *text ? g_utf8_casefold(text, -1) : NULL;
+
+    if(g_strcmp0(key, self->search_key) == 0 &&
+       gtk_tree_view_get_model(GTK_TREE_VIEW(self->tree_view)) == (self->filter ? self->filter : self->model))
+    {
+        g_free(key);
+        return;
+    }
+
+    g_free(self->search_key);
+    self->search_key = key;
+    user_picker_update_view_model(self);
+}
+
+static void
+user_picker_move_active(GreeterUserPicker* self,
+                        gboolean forward)
+{
+    GtkTreeIter iter;
+    gboolean available;
+
+    if(!self->model)
+        return;
+
+    if(greeter_user_picker_get_active_iter(self, &iter))
+        available = forward ? gtk_tree_model_iter_next(self->model, &iter) : gtk_tree_model_iter_previous(self->model, &iter);
+    else
+        available = gtk_tree_model_get_iter_first(self->model, &iter);
+
+    if(available)
+        greeter_user_picker_set_active_iter(self, &iter);
+}
+
+static void
+user_picker_move_cursor(GreeterUserPicker* self,
+                        gint delta)
+{
+    GtkTreeModel* model = gtk_tree_view_get_model(GTK_TREE_VIEW(self->tree_view));
+    gint n_rows = model ? gtk_tree_model_iter_n_children(model, NULL) : 0;
+    GtkTreePath* path = NULL;
+    gint index = -1;
+
+    if(n_rows == 0)
+        return;
+
+    gtk_tree_view_get_cursor(GTK_TREE_VIEW(self->tree_view), &path, NULL);
+    if(path)
+    {
+        index = gtk_tree_path_get_indices(path)[0];
+        gtk_tree_path_free(path);
+    }
+
+    path = gtk_tree_path_new_from_indices(CLAMP(index + delta, 0, n_rows - 1), -1);
+    gtk_tree_view_set_cursor(GTK_TREE_VIEW(self->tree_view), path, NULL, FALSE);
+    gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(self->tree_view), path, NULL, FALSE, 0.0, 0.0);
+    gtk_tree_path_free(path);
+}
+
+static gboolean
+user_picker_text_matches(const gchar* text,
+                         const gchar* key)
+{
+    if(!text)
+        return FALSE;
+
+    gchar* folded = g_utf8_casefold(text, -1);
+    gboolean matches = strstr(folded, key) != NULL;
+    g_free(folded);
+    return matches;
+}
+
+/* Callbacks */
+
+static gboolean
+user_picker_filter_visible_cb(GtkTreeModel* model,
+                              GtkTreeIter* iter,
+                              GreeterUserPicker* self)
+{
+    gchar* name = NULL;
+    gchar* label = NULL;
+
+    gtk_tree_model_get(model, iter,
+                       GREETER_USER_MODEL_COLUMN_NAME, &name,
+                       GREETER_USER_MODEL_COLUMN_LABEL, &label,
+                       -1);
+
+    /* Special entries ("*other", "*guest") are always available */
+    gboolean visible = (name && name[0] == '*') ||
+                       user_picker_text_matches(name, self->search_key) ||
+                       user_picker_text_matches(label, self->search_key);
+
+    g_free(name);
+    g_free(label);
+    return visible;
+}
+
+static void
+user_picker_model_row_changed_cb(GtkTreeModel* model,
+                                 GtkTreePath* path,
+                                 GtkTreeIter* iter,
+                                 GreeterUserPicker* self)
+{
+    if(!self->active)
+        return;
+
+    GtkTreePath* active_path = gtk_tree_row_reference_get_path(self->active);
+    if(active_path && gtk_tree_path_compare(path, active_path) == 0)
+        user_picker_update_label(self);
+    gtk_tree_path_free(active_path);
+}
+
+static void
+user_picker_model_row_deleted_cb(GtkTreeModel* model,
+                                 GtkTreePath* path,
+                                 GreeterUserPicker* self)
+{
+    /* Row references are updated before handlers are called */
+    if(self->active && !gtk_tree_row_reference_valid(self->active))
+    {
+        g_clear_pointer(&self->active, gtk_tree_row_reference_free);
+        user_picker_update_label(self);
+        g_signal_emit(self, user_picker_signals[USER_PICKER_SIGNAL_CHANGED], 0);
+    }
+}
+
+static void
+user_picker_row_activated_cb(GtkTreeView* tree_view,
+                             GtkTreePath* path,
+                             GtkTreeViewColumn* column,
+                             GreeterUserPicker* self)
+{
+    GtkTreePath* model_path = NULL;
+    GtkTreeIter iter;
+
+    if(self->filter)
+        model_path = gtk_tree_model_filter_convert_path_to_child_path(GTK_TREE_MODEL_FILTER(self->filter), path);
+    else
+        model_path = gtk_tree_path_copy(path);
+
+    /* Close popup first: "changed" handlers may want to move focus */
+    greeter_user_picker_popdown(self);
+
+    if(model_path && self->model && gtk_tree_model_get_iter(self->model, &iter, model_path))
+        greeter_user_picker_set_active_iter(self, &iter);
+    gtk_tree_path_free(model_path);
+}
+
+static void
+user_picker_search_changed_cb(GtkSearchEntry* entry,
+                              GreeterUserPicker* self)
+{
+    user_picker_set_search_text(self, gtk_entry_get_text(GTK_ENTRY(entry)));
+}
+
+static void
+user_picker_search_activate_cb(GtkEntry* entry,
+                               GreeterUserPicker* self)
+{
+    GtkTreePath* path = NULL;
+
+    /* Search results can be outdated: "search-changed" is delayed */
+    user_picker_set_search_text(self, gtk_entry_get_text(entry));
+
+    gtk_tree_view_get_cursor(GTK_TREE_VIEW(self->tree_view), &path, NULL);
+    if(path)
+    {
+        user_picker_row_activated_cb(GTK_TREE_VIEW(self->tree_view), path, NULL, self);
+        gtk_tree_path_free(path);
+    }
+}
+
+static gboolean
+user_picker_search_key_press_cb(GtkWidget* widget,
+                                GdkEventKey* event,
+                                GreeterUserPicker* self)
+{
+    switch(event->keyval)
+    {
+        case GDK_KEY_Up:
+        case GDK_KEY_KP_Up:
+            user_picker_move_cursor(self, -1);
+            return TRUE;
+        case GDK_KEY_Down:
+        case GDK_KEY_KP_Down:
+            user_picker_move_cursor(self, +1);
+            return TRUE;
+        case GDK_KEY_Page_Up:
+        case GDK_KEY_KP_Page_Up:
+            user_picker_move_cursor(self, -USER_PICKER_VISIBLE_ROWS);
+            return TRUE;
+        case GDK_KEY_Page_Down:
+        case GDK_KEY_KP_Page_Down:
+            user_picker_move_cursor(self, +USER_PICKER_VISIBLE_ROWS);
+            return TRUE;
+        case GDK_KEY_Escape:
+            greeter_user_picker_popdown(self);
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+user_picker_popover_closed_cb(GtkPopover* popover,
+                              GreeterUserPicker* self)
+{
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(self), FALSE);
+}
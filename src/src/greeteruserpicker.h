@@ -0,0 +1,42 @@
+#ifndef GREETER_USER_PICKER_H
+#define GREETER_USER_PICKER_H
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define GREETER_USER_PICKER_TYPE            (greeter_user_picker_get_type())
+#define GREETER_USER_PICKER(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), GREETER_USER_PICKER_TYPE, GreeterUserPicker))
+#define GREETER_USER_PICKER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), GREETER_USER_PICKER_TYPE, GreeterUserPickerClass))
+#define GREETER_IS_USER_PICKER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), GREETER_USER_PICKER_TYPE))
+#define GREETER_IS_USER_PICKER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), GREETER_USER_PICKER_TYPE))
+
+typedef struct _GreeterUserPicker           GreeterUserPicker;
+typedef struct _GreeterUserPickerClass      GreeterUserPickerClass;
+
+GType greeter_user_picker_get_type(void) G_GNUC_CONST;
+
+/* Replacement for GtkComboBox with GreeterUserModel columns.
+ * Popup is a fixed height rows list with search entry: its cost does not depend on number of rows.
+ * "changed" signal is emitted when active row is changed. */
+GtkWidget* greeter_user_picker_new                  (void);
+void greeter_user_picker_set_model                  (GreeterUserPicker* picker,
+                                                     GtkTreeModel* model);
+GtkTreeModel* greeter_user_picker_get_model         (GreeterUserPicker* picker);
+/* Batch of model changes: closed popup list does not follow changes row by row until thawed.
+ * Active row is kept. */
+void greeter_user_picker_freeze_view                (GreeterUserPicker* picker);
+void greeter_user_picker_thaw_view                  (GreeterUserPicker* picker);
+gboolean greeter_user_picker_get_active_iter        (GreeterUserPicker* picker,
+                                                     GtkTreeIter* iter);
+/* NULL to unset active row */
+void greeter_user_picker_set_active_iter            (GreeterUserPicker* picker,
+                                                     GtkTreeIter* iter);
+void greeter_user_picker_popup                      (GreeterUserPicker* picker,
+                                                     const gchar* search_text);
+void greeter_user_picker_popdown                    (GreeterUserPicker* picker);
+
+G_END_DECLS
+
+#endif // GREETER_USER_PICKER_H
@@ -0,0 +1,97 @@
+/* automatically generated from lightdm-gtk-greeter-power.glade */
+#ifdef __SUNPRO_C
+#pragma align 4 (lightdm_gtk_greeter_power_ui)
+#endif
+#ifdef __GNUC__
+static const char lightdm_gtk_greeter_power_ui[] __attribute__ ((__aligned__ (4))) =
+#else
+static const char lightdm_gtk_greeter_power_ui[] =
+#endif
+{
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?><interface><requires lib=\"gt"
+  "k+\" version=\"3.4\"/><object class=\"GtkEventBox\" id=\"power_window\""
+  "><property name=\"name\">power_window</property><property name=\"can_fo"
+  "cus\">False</property><property name=\"halign\">center</property><prope"
+  "rty name=\"valign\">center</property><signal name=\"key-press-event\" h"
+  "andler=\"power_window_key_press_event_cb\" swapped=\"no\"/><child><obje"
+  "ct class=\"GtkBox\" id=\"box3\"><property name=\"visible\">True</proper"
+  "ty><property name=\"can_focus\">False</property><property name=\"orient"
+  "ation\">vertical</property><child><object class=\"GtkEventBox\" id=\"po"
+  "wer_content_frame\"><property name=\"name\">content_frame</property><pr"
+  "operty name=\"visible\">True</property><property name=\"can_focus\">Fal"
+  "se</property><child><object class=\"GtkGrid\" id=\"grid2\"><property na"
+  "me=\"visible\">True</property><property name=\"can_focus\">False</prope"
+  "rty><property name=\"margin_left\">24</property><property name=\"margin"
+  "_right\">24</property><property name=\"margin_top\">24</property><prope"
+  "rty name=\"margin_bottom\">24</property><property name=\"row_spacing\">"
+  "6</property><property name=\"column_spacing\">6</property><child><objec"
+  "t class=\"GtkImage\" id=\"power_icon\"><property name=\"visible\">True<"
+  "/property><property name=\"can_focus\">False</property><property name=\""
+  "margin_left\">6</property><property name=\"margin_right\">12</property>"
+  "<property name=\"margin_top\">6</property><property name=\"margin_botto"
+  "m\">6</property><property name=\"stock\">gtk-missing-image</property></"
+  "object><packing><property name=\"left_attach\">0</property><property na"
+  "me=\"top_attach\">0</property><property name=\"height\">2</property></p"
+  "acking></child><child><object class=\"GtkLabel\" id=\"power_title\"><pr"
+  "operty name=\"visible\">True</property><property name=\"can_focus\">Fal"
+  "se</property><property name=\"halign\">start</property><property name=\""
+  "margin_bottom\">6</property><property name=\"hexpand\">True</property><"
+  "property name=\"label\">[title]</property><attributes><attribute name=\""
+  "weight\" value=\"semibold\"/></attributes></object><packing><property n"
+  "ame=\"left_attach\">1</property><property name=\"top_attach\">0</proper"
+  "ty></packing></child><child><object class=\"GtkLabel\" id=\"power_text\""
+  "><property name=\"visible\">True</property><property name=\"can_focus\""
+  ">False</property><property name=\"halign\">start</property><property na"
+  "me=\"hexpand\">True</property><property name=\"label\">[text]</property"
+  "></object><packing><property name=\"left_attach\">1</property><property"
+  " name=\"top_attach\">1</property></packing></child></object></child></o"
+  "bject><packing><property name=\"expand\">False</property><property name"
+  "=\"fill\">True</property><property name=\"position\">0</property></pack"
+  "ing></child><child><object class=\"GtkEventBox\" id=\"power_buttonbox_f"
+  "rame\"><property name=\"name\">buttonbox_frame</property><property name"
+  "=\"visible\">True</property><property name=\"can_focus\">False</propert"
+  "y><child><object class=\"GtkButtonBox\" id=\"buttonbox1\"><property nam"
+  "e=\"visible\">True</property><property name=\"can_focus\">False</proper"
+  "ty><property name=\"margin_left\">24</property><property name=\"margin_"
+  "right\">24</property><property name=\"margin_top\">24</property><proper"
+  "ty name=\"margin_bottom\">24</property><property name=\"spacing\">6</pr"
+  "operty><property name=\"layout_style\">end</property><child><object cla"
+  "ss=\"GtkButton\" id=\"power_cancel_button\"><property name=\"label\" tr"
+  "anslatable=\"yes\">Cancel</property><property name=\"name\">cancel_butt"
+  "on</property><property name=\"visible\">True</property><property name=\""
+  "can_focus\">True</property><signal name=\"clicked\" handler=\"power_but"
+  "ton_clicked_cb\" swapped=\"no\"/></object><packing><property name=\"exp"
+  "and\">False</property><property name=\"fill\">True</property><property "
+  "name=\"position\">0</property></packing></child><child><object class=\""
+  "GtkButton\" id=\"power_ok_button\"><property name=\"label\" translatabl"
+  "e=\"yes\">OK</property><property name=\"name\">power_ok_button</propert"
+  "y><property name=\"visible\">True</property><property name=\"can_focus\""
+  ">True</property><signal name=\"clicked\" handler=\"power_button_clicked"
+  "_cb\" swapped=\"no\"/></object><packing><property name=\"expand\">False"
+  "</property><property name=\"fill\">True</property><property name=\"posi"
+  "tion\">1</property></packing></child></object></child></object><packing"
+  "><property name=\"expand\">False</property><property name=\"fill\">True"
+  "</property><property name=\"position\">1</property></packing></child></"
+  "object></child><style><class name=\"background\"/></style></object><obj"
+  "ect class=\"GtkMenuItem\" id=\"suspend_menuitem\"><property name=\"visi"
+  "ble\">True</property><property name=\"can_focus\">False</property><prop"
+  "erty name=\"label\" translatable=\"yes\">Suspend</property><signal name"
+  "=\"activate\" handler=\"suspend_cb\" swapped=\"no\"/></object><object c"
+  "lass=\"GtkMenuItem\" id=\"hibernate_menuitem\"><property name=\"visible"
+  "\">True</property><property name=\"can_focus\">False</property><propert"
+  "y name=\"label\" translatable=\"yes\">Hibernate</property><signal name="
+  "\"activate\" handler=\"hibernate_cb\" swapped=\"no\"/></object><object "
+  "class=\"GtkMenuItem\" id=\"restart_menuitem\"><property name=\"visible\""
+  ">True</property><property name=\"can_focus\">False</property><property "
+  "name=\"label\" translatable=\"yes\">Restart...</property><signal name=\""
+  "activate\" handler=\"restart_cb\" swapped=\"no\"/></object><object clas"
+  "s=\"GtkMenuItem\" id=\"shutdown_menuitem\"><property name=\"use_action_"
+  "appearance\">False</property><property name=\"visible\">True</property>"
+  "<property name=\"can_focus\">False</property><property name=\"accel_pat"
+  "h\">&lt;Login&gt;/power/shutdown</property><property name=\"label\" tra"
+  "nslatable=\"yes\">Shut Down...</property><signal name=\"activate\" hand"
+  "ler=\"shutdown_cb\" swapped=\"no\"/></object></interface>"
+};
+
+static const unsigned lightdm_gtk_greeter_power_ui_length = 5583u;
+
@@ -23,7 +23,6 @@
 #include <gdk/gdkx.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
-#include <sys/mman.h>
 #include <sys/wait.h>
 #include <glib.h>
 #include <gtk/gtkx.h>
@@ -49,12 +48,29 @@
 
 #include "src/greetermenubar.h"
 #include "src/greeterbackground.h"
+#include "src/greetersecure.h"
+#include "src/greetertrace.h"
+#include "src/greeteriobroker.h"
+#include "src/greeterimagecache.h"
+#include "src/greeterlayoutcache.h"
+#include "src/greeterusermodel.h"
+#include "src/greeteruserpicker.h"
 #include "src/lightdm-gtk-greeter-ui.h"
+#include "src/lightdm-gtk-greeter-power-ui.h"
 #include "src/lightdm-gtk-greeter-css-fallback.h"
 #include "src/lightdm-gtk-greeter-css-application.h"
 
 static LightDMGreeter *greeter;
 
+/* Connection to daemon is established while UI is being constructed */
+static gboolean greeter_connecting = FALSE;
+static gboolean greeter_connected = FALSE;
+/* SIGTERM can arrive before gtk_main () is running, e.g. in wait_for_greeter_connection () */
+static gboolean quit_requested = FALSE;
+static gint64 startup_time, greeter_connected_time;
+static void greeter_connect_cb (GObject *object, GAsyncResult *result, gpointer user_data);
+static gboolean wait_for_greeter_connection (void);
+
 /* State file */
 static GKeyFile *state;
 static gchar *state_filename;
@@ -75,7 +91,8 @@ static GtkOverlay *screen_overlay;
 /* Login window */
 static GtkWidget    *login_window;
 static GtkImage     *user_image;
-static GtkComboBox  *user_combo;
+static GreeterUserPicker *user_combo;
+static GreeterUserModel *user_model;
 static GtkEntry     *username_entry, *password_entry;
 static GtkLabel     *message_label;
 static GtkInfoBar   *info_bar;
@@ -88,7 +105,7 @@ static GtkWidget    *power_menuitem, *session_menuitem, *language_menuitem, *a11
 static GtkWidget    *suspend_menuitem, *hibernate_menuitem, *restart_menuitem, *shutdown_menuitem;
 static GtkWidget    *contrast_menuitem, *font_menuitem, *keyboard_menuitem, *reader_menuitem;
 static GtkWidget    *clock_label, *session_badge;
-static GtkMenu      *session_menu, *language_menu, *layout_menu;
+static GtkMenu      *session_menu, *language_menu, *layout_menu, *power_menu;
 
 /* Power window */
 static GtkWidget    *power_window;
@@ -99,6 +116,7 @@ static GtkImage     *power_icon;
 static const gchar *POWER_WINDOW_DATA_LOOP = "power-window-loop";           /* <GMainLoop*> */
 static const gchar *POWER_WINDOW_DATA_RESPONSE = "power-window-response";   /* <GtkResponseType> */
 
+static gboolean build_power_ui (void);
 static gboolean show_power_prompt (const gchar *action, const gchar* icon, const gchar* title, const gchar* message);
 void power_button_clicked_cb (GtkButton *button, gpointer user_data);
 gboolean power_window_key_press_event_cb (GtkWidget *widget, GdkEventKey *event, gpointer user_data);
@@ -144,8 +162,20 @@ static gboolean message_label_is_empty (void);
 static void set_message_label (LightDMMessageType type, const gchar *text);
 
 /* User image */
-static GdkPixbuf *default_user_pixbuf = NULL;
+static cairo_surface_t *default_user_surface = NULL;
 static gchar *default_user_icon = "avatar-default";
+static const gint USER_IMAGE_SIZE = 80;
+/* Scaled user images are kept between greeter runs, see greeterimagecache.h */
+static gchar *user_image_cache_dir = NULL;
+static const gchar *USER_IMAGE_CACHE_SUBDIR = "avatars";
+/* Disk space used by cached user images, about 25 KB per user: least recently used are removed at startup */
+static const gsize USER_IMAGE_CACHE_LIMIT = 16*1024*1024;
+/* Image cache key: stretched to requested size, 0x0 for original size */
+static const gint USER_IMAGE_CACHE_MODE = 0;
+/* Images from stalled home directories are given up after this time (ms) */
+static const guint USER_IMAGE_TIMEOUT = 3000;
+/* Cancelled when another user is selected */
+static GCancellable *user_image_cancellable = NULL;
 static void set_user_image (const gchar *username);
 
 /* External command (keyboard, reader) */
@@ -176,15 +206,24 @@ static void a11y_menuitem_toggled_cb (GtkCheckMenuItem *item, const gchar* name)
 
 /* Session */
 static gchar *current_session;
+/* Menu items are created on first popup, until then only current_session is tracked */
+static gboolean session_menu_filled = FALSE;
 static gboolean is_valid_session (GList* items, const gchar* session);
 static gchar* get_session (void);
 static void set_session (const gchar *session);
+static void fill_session_menu (void);
+static void session_menu_show_cb (GtkWidget *menu, gpointer user_data);
 void session_selected_cb (GtkMenuItem *menuitem, gpointer user_data);
 
 /* Sesion language */
 static gchar *current_language;
+/* Menu items are created on first popup, installed locales are not enumerated until then */
+static gboolean language_menu_filled = FALSE;
+static gboolean is_valid_language (const gchar *language);
 static gchar* get_language (void);
 static void set_language (const gchar *language);
+static void fill_language_menu (void);
+static void language_menu_show_cb (GtkWidget *menu, gpointer user_data);
 void language_selected_cb (GtkMenuItem *menuitem, gpointer user_data);
 
 /* Screensaver values */
@@ -192,6 +231,8 @@ static int timeout, interval, prefer_blanking, allow_exposures;
 
 /* Handling monitors backgrounds */
 static const gint USER_BACKGROUND_DELAY = 250;
+/* Default size of user backgrounds cache, megabytes */
+static const gint USER_BACKGROUND_CACHE_SIZE = 64;
 static GreeterBackground *greeter_background;
 
 /* Authentication state */
@@ -251,6 +292,11 @@ static const gchar *SESSION_DATA_KEY = "session-key";       /* <gchar*> session
 /* Layout indicator */
 #ifdef HAVE_LIBXKLAVIER
 static XklEngine *xkl_engine;
+/* Descriptions of known layouts: mapped cache file or, on cache miss, table filled from XKB registry */
+static GreeterLayoutCache *layout_descriptions_cache;
+static GHashTable *layout_descriptions;
+static gchar *layout_descriptions_cache_filename;
+static const gchar *XKB_RULES_DIR = "/usr/share/X11/xkb/rules";
 static const gchar *LAYOUT_DATA_GROUP = "layout-group";     /* <gchar*> */
 #else
 static const gchar *LAYOUT_DATA_NAME = "layout-name";       /* <gchar*> */
@@ -272,6 +318,9 @@ static void update_layouts_menu_state (void);
 static void xkl_state_changed_cb (XklEngine *engine, XklEngineStateChange change, gint group, gboolean restore, gpointer user_data);
 static void xkl_config_changed_cb (XklEngine *engine, gpointer user_data);
 static GdkFilterReturn xkl_xevent_filter (GdkXEvent *xev, GdkEvent *event, gpointer  data);
+static const gchar *get_layout_description (const gchar *layout, const gchar *variant);
+static void load_layout_descriptions (void);
+static gchar *get_xkb_rules_path (void);
 #endif
 
 /* a11y indicator */
@@ -285,6 +334,8 @@ void a11y_reader_cb (GtkCheckMenuItem *item, gpointer user_data);
 
 /* Power indciator */
 static void power_menu_cb (GtkWidget *menuitem, gpointer userdata);
+static gboolean power_shutdown_accel_cb (GtkAccelGroup *accel_group, GObject *acceleratable,
+                                         guint keyval, GdkModifierType modifier, gpointer user_data);
 void suspend_cb (GtkWidget *widget, LightDMGreeter *greeter);
 void hibernate_cb (GtkWidget *widget, LightDMGreeter *greeter);
 void restart_cb (GtkWidget *widget, LightDMGreeter *greeter);
@@ -434,16 +485,77 @@ sigterm_cb (gpointer user_data)
     g_slist_foreach (pids_to_close, (GFunc)close_pid, GINT_TO_POINTER (FALSE));
     g_slist_free (pids_to_close);
     pids_to_close = NULL;
-    gtk_main_quit ();
+    quit_requested = TRUE;
+    if (gtk_main_level () > 0)
+        gtk_main_quit ();
 }
 
 /* Power window */
 
+/* Power dialog and power menu items are rarely used: they are built from separate UI fragment on first use */
+static gboolean
+build_power_ui (void)
+{
+    GtkBuilder *builder;
+    GError *error = NULL;
+    gint64 start_time;
+
+    if (power_window)
+        return TRUE;
+
+    GREETER_TRACE_BEGIN ("build_power_ui");
+    start_time = g_get_monotonic_time ();
+    builder = gtk_builder_new ();
+    if (!gtk_builder_add_from_string (builder, lightdm_gtk_greeter_power_ui,
+                                      lightdm_gtk_greeter_power_ui_length, &error))
+    {
+        g_warning ("Error loading power UI: %s", error->message);
+        g_clear_error (&error);
+        g_object_unref (builder);
+        GREETER_TRACE_END ("build_power_ui");
+        return FALSE;
+    }
+
+    /* Power dialog */
+    power_window = GTK_WIDGET (gtk_builder_get_object (builder, "power_window"));
+    power_ok_button = GTK_BUTTON (gtk_builder_get_object (builder, "power_ok_button"));
+    power_cancel_button = GTK_BUTTON (gtk_builder_get_object (builder, "power_cancel_button"));
+    power_title = GTK_LABEL (gtk_builder_get_object (builder, "power_title"));
+    power_text = GTK_LABEL (gtk_builder_get_object (builder, "power_text"));
+    power_icon = GTK_IMAGE (gtk_builder_get_object (builder, "power_icon"));
+    gtk_overlay_add_overlay (screen_overlay, power_window);
+
+    /* Power menu */
+    suspend_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "suspend_menuitem"));
+    hibernate_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "hibernate_menuitem"));
+    restart_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "restart_menuitem"));
+    shutdown_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "shutdown_menuitem"));
+    gtk_menu_shell_append (GTK_MENU_SHELL (power_menu), suspend_menuitem);
+    gtk_menu_shell_append (GTK_MENU_SHELL (power_menu), hibernate_menuitem);
+    gtk_menu_shell_append (GTK_MENU_SHELL (power_menu), restart_menuitem);
+    gtk_menu_shell_append (GTK_MENU_SHELL (power_menu), shutdown_menuitem);
+
+    gtk_builder_connect_signals (builder, greeter);
+
+    GSList *objects = gtk_builder_get_objects (builder);
+    g_debug ("Power UI loaded in %" G_GINT64_FORMAT " us: %u objects",
+             g_get_monotonic_time () - start_time, g_slist_length (objects));
+    g_slist_free (objects);
+
+    /* Widgets are owned by overlay and menu now */
+    g_object_unref (builder);
+    GREETER_TRACE_END ("build_power_ui");
+    return TRUE;
+}
+
 static gboolean
 show_power_prompt (const gchar *action, const gchar* icon, const gchar* title, const gchar* message)
 {
     gchar *new_message = NULL;
 
+    if (!build_power_ui ())
+        return FALSE;
+
     /* Check if there are still users logged in, count them and if so, display a warning */
     gint logged_in_users = 0;
     GList *items = lightdm_user_list_get_users (lightdm_user_list_get_instance ());
@@ -704,44 +816,106 @@ set_message_label (LightDMMessageType type, const gchar *text)
 
 /* User image */
 
+/* Called in IO broker thread too: cached image costs one stat() and one small read */
+static cairo_surface_t *
+load_user_image_surface (const gchar *path, gint size, const gchar *cache_dir, GError **error)
+{
+    cairo_surface_t *surface = NULL;
+    GdkPixbuf *pixbuf;
+
+    if (cache_dir)
+    {
+        surface = greeter_image_cache_lookup (cache_dir, path, USER_IMAGE_CACHE_MODE, size, size);
+        if (surface)
+            return surface;
+    }
+
+    if (size > 0)
+        pixbuf = gdk_pixbuf_new_from_file_at_scale (path, size, size, FALSE, error);
+    else
+        pixbuf = gdk_pixbuf_new_from_file (path, error);
+    if (!pixbuf)
+        return NULL;
+
+    /* Premultiplied pixels: cached image is used without any conversion */
+    surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, 1, NULL);
+    g_object_unref (pixbuf);
+    if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS)
+    {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s: %s", path,
+                     cairo_status_to_string (cairo_surface_status (surface)));
+        cairo_surface_destroy (surface);
+        return NULL;
+    }
+
+    if (cache_dir)
+        greeter_image_cache_store (cache_dir, path, USER_IMAGE_CACHE_MODE, size, size, surface);
+    return surface;
+}
+
+/* Called in IO broker thread */
+static gpointer
+trim_user_image_cache (const gchar *cache_dir, gpointer data, GError **error)
+{
+    greeter_image_cache_trim (cache_dir, USER_IMAGE_CACHE_LIMIT);
+    return NULL;
+}
+
+/* Called in IO broker thread */
+static gpointer
+load_user_image (const gchar *path, gpointer cache_dir, GError **error)
+{
+    return load_user_image_surface (path, USER_IMAGE_SIZE, cache_dir, error);
+}
+
+static void
+user_image_loaded_cb (const gchar *path, gpointer result, const GError *error, gpointer data)
+{
+    cairo_surface_t *image = result;
+
+    if (image)
+    {
+        gtk_image_set_from_surface (GTK_IMAGE (user_image), image);
+        cairo_surface_destroy (image);
+    }
+    else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to load user image: %s", error ? error->message : path);
+}
+
 static void
 set_user_image (const gchar *username)
 {
-    const gchar *path;
+    const gchar *path = NULL;
     LightDMUser *user = NULL;
-    GdkPixbuf *image = NULL;
-    GError *error = NULL;
 
     if (!gtk_widget_get_visible (GTK_WIDGET (user_image)))
         return;
 
+    if (user_image_cancellable)
+    {
+        g_cancellable_cancel (user_image_cancellable);
+        g_clear_object (&user_image_cancellable);
+    }
+
     if (username)
         user = lightdm_user_list_get_user_by_name (lightdm_user_list_get_instance (), username);
-
     if (user)
-    {
         path = lightdm_user_get_image (user);
-        if (path)
-        {
-            image = gdk_pixbuf_new_from_file_at_scale (path, 80, 80, FALSE, &error);
-            if (image)
-            {
-                gtk_image_set_from_pixbuf (GTK_IMAGE (user_image), image);
-                g_object_unref (image);
-                return;
-            }
-            else
-            {
-                g_warning ("Failed to load user image: %s", error->message);
-                g_clear_error (&error);
-            }
-        }
-    }
 
-    if (default_user_pixbuf)
-        gtk_image_set_from_pixbuf (GTK_IMAGE (user_image), default_user_pixbuf);
+    /* Default image is displayed until user image is loaded */
+    if (default_user_surface)
+        gtk_image_set_from_surface (GTK_IMAGE (user_image), default_user_surface);
     else
         gtk_image_set_from_icon_name (GTK_IMAGE (user_image), default_user_icon, GTK_ICON_SIZE_DIALOG);
+
+    if (path)
+    {
+        user_image_cancellable = g_cancellable_new ();
+        greeter_io_broker_submit (path, USER_IMAGE_TIMEOUT, user_image_cancellable,
+                                  load_user_image, g_strdup (user_image_cache_dir), g_free,
+                                  (GDestroyNotify)cairo_surface_destroy,
+                                  user_image_loaded_cb, NULL);
+    }
 }
 
 /* MenuCommand */
@@ -964,31 +1138,37 @@ set_session (const gchar *session)
 
     if (gtk_widget_get_visible (session_menuitem))
     {
-        GList *menu_iter = NULL;
-        GList *menu_items = gtk_container_get_children (GTK_CONTAINER (session_menu));
         if (session)
         {
-            for (menu_iter = menu_items; menu_iter != NULL; menu_iter = g_list_next (menu_iter))
-                if (g_strcmp0 (session, g_object_get_data (G_OBJECT (menu_iter->data), SESSION_DATA_KEY)) == 0)
-                {
-                    /* Set menuitem-image to session-badge */
-                    GtkIconTheme *icon_theme = gtk_icon_theme_get_default ();
-                    gchar* session_name = g_ascii_strdown (session, -1);
-                    gchar* icon_name = g_strdup_printf ("%s_badge-symbolic", session_name);
-                    g_free (session_name);
-                    if (gtk_icon_theme_has_icon (icon_theme, icon_name))
-                        gtk_image_set_from_icon_name (GTK_IMAGE (session_badge), icon_name, GTK_ICON_SIZE_MENU);
-                    else
-                        gtk_image_set_from_icon_name (GTK_IMAGE (session_badge), "document-properties-symbolic", GTK_ICON_SIZE_MENU);
-                    g_free (icon_name);
-                    break;
-                }
+            /* Set menuitem-image to session-badge */
+            GtkIconTheme *icon_theme = gtk_icon_theme_get_default ();
+            gchar* session_name = g_ascii_strdown (session, -1);
+            gchar* icon_name = g_strdup_printf ("%s_badge-symbolic", session_name);
+            g_free (session_name);
+            if (gtk_icon_theme_has_icon (icon_theme, icon_name))
+                gtk_image_set_from_icon_name (GTK_IMAGE (session_badge), icon_name, GTK_ICON_SIZE_MENU);
+            else
+                gtk_image_set_from_icon_name (GTK_IMAGE (session_badge), "document-properties-symbolic", GTK_ICON_SIZE_MENU);
+            g_free (icon_name);
         }
-        if (!menu_iter)
-            menu_iter = menu_items;
 
-        if (menu_iter)
-	        gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menu_iter->data), TRUE);
+        if (session_menu_filled)
+        {
+            GList *menu_iter = NULL;
+            GList *menu_items = gtk_container_get_children (GTK_CONTAINER (session_menu));
+            if (session)
+            {
+                for (menu_iter = menu_items; menu_iter != NULL; menu_iter = g_list_next (menu_iter))
+                    if (g_strcmp0 (session, g_object_get_data (G_OBJECT (menu_iter->data), SESSION_DATA_KEY)) == 0)
+                        break;
+            }
+            if (!menu_iter)
+                menu_iter = menu_items;
+
+            if (menu_iter)
+                gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menu_iter->data), TRUE);
+            g_list_free (menu_items);
+        }
     }
 
     g_free (current_session);
@@ -996,6 +1176,43 @@ set_session (const gchar *session)
     g_free (last_session);
 }
 
+static void
+fill_session_menu (void)
+{
+    const GList *item;
+    GSList *sessions = NULL;
+
+    if (session_menu_filled)
+        return;
+    session_menu_filled = TRUE;
+
+    GREETER_TRACE_BEGIN ("fill_session_menu");
+    for (item = lightdm_get_sessions (); item; item = item->next)
+    {
+        LightDMSession *session = item->data;
+        GtkWidget *radiomenuitem;
+
+        radiomenuitem = gtk_radio_menu_item_new_with_label (sessions, lightdm_session_get_name (session));
+        g_object_set_data (G_OBJECT (radiomenuitem), SESSION_DATA_KEY, (gpointer) lightdm_session_get_key (session));
+        sessions = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (radiomenuitem));
+        g_signal_connect (G_OBJECT (radiomenuitem), "activate", G_CALLBACK (session_selected_cb), NULL);
+        gtk_menu_shell_append (GTK_MENU_SHELL (session_menu), radiomenuitem);
+        gtk_widget_show (GTK_WIDGET (radiomenuitem));
+    }
+
+    /* Mark current session, set_session () replaces current_session */
+    gchar *session = g_strdup (current_session);
+    set_session (session);
+    g_free (session);
+    GREETER_TRACE_END ("fill_session_menu");
+}
+
+static void
+session_menu_show_cb (GtkWidget *menu, gpointer user_data)
+{
+    fill_session_menu ();
+}
+
 void
 session_selected_cb (GtkMenuItem *menuitem, gpointer user_data)
 {
@@ -1006,15 +1223,65 @@ session_selected_cb (GtkMenuItem *menuitem, gpointer user_data)
 
 /* Session language */
 
+static gboolean
+is_valid_language (const gchar *language)
+{
+    const GList *item;
+
+    for (item = lightdm_get_languages (); item; item = item->next)
+        if (g_strcmp0 (language, lightdm_language_get_code (item->data)) == 0)
+            return TRUE;
+    return FALSE;
+}
+
+/* Language from LANG in the form of lightdm_get_languages () codes: "en_US.UTF-8" => "en_US.utf8".
+ * NULL if LANG is not set or is not a language ("C", "POSIX") */
+static gchar*
+get_environment_language (void)
+{
+    const gchar *lang = g_getenv ("LANG");
+    const gchar *codeset, *modifier;
+    gchar *name;
+    gboolean utf8;
+
+    if (!lang || !lang[0] || g_strcmp0 (lang, "C") == 0 || g_strcmp0 (lang, "POSIX") == 0)
+        return NULL;
+
+    codeset = strchr (lang, '.');
+    if (!codeset)
+        return g_strdup (lang);
+
+    modifier = strchr (codeset, '@');
+    name = modifier ? g_strndup (codeset + 1, modifier - codeset - 1) : g_strdup (codeset + 1);
+    utf8 = g_ascii_strcasecmp (name, "utf-8") == 0 || g_ascii_strcasecmp (name, "utf8") == 0;
+    g_free (name);
+
+    if (!utf8)
+        return g_strdup (lang);
+    return g_strdup_printf ("%.*s.utf8%s", (gint)(codeset - lang), lang, modifier ? modifier : "");
+}
+
 static gchar*
 get_language (void)
 {
     GList *menu_items, *menu_iter;
 
+    /* Language menu was never opened: selection is not validated yet */
+    if (current_language && !language_menu_filled && gtk_widget_get_visible (language_menuitem) &&
+        !is_valid_language (current_language))
+    {
+        g_debug ("Language %s is not installed, using default", current_language);
+        g_free (current_language);
+        current_language = lightdm_get_language () ? g_strdup (lightdm_language_get_code (lightdm_get_language ())) : NULL;
+    }
+
     /* if the user manually selected a language, use it */
     if (current_language)
         return g_strdup (current_language);
 
+    if (!language_menu_filled)
+        return NULL;
+
     menu_items = gtk_container_get_children (GTK_CONTAINER (language_menu));
     for (menu_iter = menu_items; menu_iter != NULL; menu_iter = g_list_next (menu_iter))
     {
@@ -1025,6 +1292,17 @@ get_language (void)
     return NULL;
 }
 
+/* Readable name of language in menu item, a single LightDMLanguage does not enumerate installed locales */
+static void
+set_language_label (const gchar *code)
+{
+    LightDMLanguage *language = g_object_new (LIGHTDM_TYPE_LANGUAGE, "code", code, NULL);
+    const gchar *name = lightdm_language_get_name (language);
+
+    gtk_menu_item_set_label (GTK_MENU_ITEM (language_menuitem), name ? name : code);
+    g_object_unref (language);
+}
+
 static void
 set_language (const gchar *language)
 {
@@ -1038,6 +1316,25 @@ set_language (const gchar *language)
         return;
     }
 
+    if (!language_menu_filled)
+    {
+        /* Validation is postponed until menu is filled or language is requested.
+           Default is taken from environment: lightdm_get_language () enumerates installed locales */
+        gchar *value = language ? g_strdup (language) : get_environment_language ();
+        /* No default to display: menu fills it, selecting lightdm default or first language */
+        if (!value)
+        {
+            g_free (current_language);
+            current_language = NULL;
+            fill_language_menu ();
+            return;
+        }
+        g_free (current_language);
+        current_language = value;
+        set_language_label (current_language);
+        return;
+    }
+
     menu_items = gtk_container_get_children (GTK_CONTAINER (language_menu));
 
     if (language)
@@ -1054,7 +1351,7 @@ set_language (const gchar *language)
                 gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (menu_iter->data), TRUE);
                 g_free (current_language);
                 current_language = g_strdup (language);
-                gtk_menu_item_set_label (GTK_MENU_ITEM (language_menuitem),language);
+                set_language_label (language);
                 return;
             }
         }
@@ -1064,8 +1361,10 @@ set_language (const gchar *language)
     if (lightdm_get_language ())
     {
         default_language = lightdm_language_get_code (lightdm_get_language ());
-        gtk_menu_item_set_label (GTK_MENU_ITEM (language_menuitem), default_language);
+        set_language_label (default_language);
     }
+    g_free (current_language);
+    current_language = NULL;
     if (default_language && g_strcmp0 (default_language, language) != 0)
         set_language (default_language);
     /* If all else fails, just use the first language from the menu */
@@ -1075,13 +1374,68 @@ set_language (const gchar *language)
         {
             if (gtk_check_menu_item_get_active (GTK_CHECK_MENU_ITEM (menu_iter->data)))
             {
-                gtk_menu_item_set_label (GTK_MENU_ITEM (language_menuitem), g_strdup (g_object_get_data (G_OBJECT (menu_iter->data), LANGUAGE_DATA_CODE)));
+                set_language_label (g_object_get_data (G_OBJECT (menu_iter->data), LANGUAGE_DATA_CODE));
                 break;
             }
         }
     }
 }
 
+static void
+fill_language_menu (void)
+{
+    const GList *item;
+    GSList *languages = NULL;
+
+    if (language_menu_filled)
+        return;
+    language_menu_filled = TRUE;
+
+    GREETER_TRACE_BEGIN ("fill_language_menu");
+    for (item = lightdm_get_languages (); item; item = item->next)
+    {
+        LightDMLanguage *language = item->data;
+        const gchar *country, *code;
+        gchar *label;
+        GtkWidget *radiomenuitem;
+
+        country = lightdm_language_get_territory (language);
+        if (country)
+            label = g_strdup_printf ("%s - %s", lightdm_language_get_name (language), country);
+        else
+            label = g_strdup (lightdm_language_get_name (language));
+
+        code = lightdm_language_get_code (language);
+        gchar *modifier = strchr (code, '@');
+        if (modifier != NULL)
+        {
+            gchar *label_new = g_strdup_printf ("%s [%s]", label, modifier+1);
+            g_free (label);
+            label = label_new;
+        }
+
+        radiomenuitem = gtk_radio_menu_item_new_with_label (languages, label);
+        g_object_set_data (G_OBJECT (radiomenuitem), LANGUAGE_DATA_CODE, (gpointer) code);
+        languages = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (radiomenuitem));
+        g_signal_connect (G_OBJECT (radiomenuitem), "activate", G_CALLBACK (language_selected_cb), NULL);
+        gtk_menu_shell_append (GTK_MENU_SHELL (language_menu), radiomenuitem);
+        gtk_widget_show (GTK_WIDGET (radiomenuitem));
+        g_free (label);
+    }
+
+    /* Validate and mark current language, set_language () replaces current_language */
+    gchar *language = g_strdup (current_language);
+    set_language (language);
+    g_free (language);
+    GREETER_TRACE_END ("fill_language_menu");
+}
+
+static void
+language_menu_show_cb (GtkWidget *menu, gpointer user_data)
+{
+    fill_language_menu ();
+}
+
 void
 language_selected_cb (GtkMenuItem *menuitem, gpointer user_data)
 {
@@ -1604,15 +1958,12 @@ static void
 update_layouts_menu (void)
 {
     #ifdef HAVE_LIBXKLAVIER
-    XklConfigRegistry *registry;
     XklConfigRec *config;
-    XklConfigItem *config_item;
+    GHashTable *old_items;
+    GList *menu_items, *item;
     GSList *menu_group = NULL;
     gint i;
 
-    g_list_free_full (gtk_container_get_children (GTK_CONTAINER (layout_menu)),
-                      (GDestroyNotify)gtk_widget_destroy);
-
     config = xkl_config_rec_new ();
     if (!xkl_config_rec_get_from_server (config, xkl_engine))
     {
@@ -1621,41 +1972,56 @@ update_layouts_menu (void)
         return;
     }
 
-    config_item = xkl_config_item_new ();
-    registry = xkl_config_registry_get_instance (xkl_engine);
-    xkl_config_registry_load (registry, FALSE);
+    /* Config changes usually add or remove a single layout: keep items of layouts that are still configured */
+    menu_items = gtk_container_get_children (GTK_CONTAINER (layout_menu));
+    old_items = g_hash_table_new (g_str_hash, g_str_equal);
+    for (item = menu_items; item; item = g_list_next (item))
+    {
+        const gchar *label = g_object_get_data (G_OBJECT (item->data), LAYOUT_DATA_LABEL);
+        if (!g_hash_table_contains (old_items, label))
+            g_hash_table_insert (old_items, (gpointer)label, item->data);
+    }
+    if (menu_items)
+        menu_group = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (menu_items->data));
+    g_list_free (menu_items);
 
     for (i = 0; config->layouts[i] != NULL; ++i)
     {
-        const gchar *layout = config->layouts[i] ? config->layouts[i] : "";
+        const gchar *layout = config->layouts[i];
         const gchar *variant = config->variants[i] ? config->variants[i] : "";
         gchar *label = strlen (variant) > 0 ? g_strdup_printf ("%s_%s", layout, variant) : g_strdup (layout);
+        GtkWidget *menuitem = g_hash_table_lookup (old_items, label);
 
-        GtkWidget *menuitem = gtk_radio_menu_item_new (menu_group);
-        menu_group = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (menuitem));
-
-        g_snprintf (config_item->name, sizeof (config_item->name), "%s", variant);
-        if (xkl_config_registry_find_variant (registry, layout, config_item))
-            gtk_menu_item_set_label (GTK_MENU_ITEM (menuitem), config_item->description);
+        if (menuitem)
+        {
+            g_hash_table_remove (old_items, label);
+            g_free (label);
+            gtk_menu_reorder_child (layout_menu, menuitem, i);
+        }
         else
         {
-            g_snprintf (config_item->name, sizeof (config_item->name), "%s", layout);
-            if (xkl_config_registry_find_layout (registry, config_item))
-                gtk_menu_item_set_label (GTK_MENU_ITEM (menuitem), config_item->description);
-            else
-                gtk_menu_item_set_label (GTK_MENU_ITEM (menuitem), label);
+            const gchar *description = get_layout_description (layout, variant);
+            if (!description)
+                description = get_layout_description (layout, NULL);
+
+            menuitem = gtk_radio_menu_item_new_with_label (menu_group, description ? description : label);
+            g_object_set_data_full (G_OBJECT (menuitem), LAYOUT_DATA_LABEL, label, g_free);
+            g_signal_connect (G_OBJECT (menuitem), "activate", G_CALLBACK (layout_selected_cb), NULL);
+            gtk_menu_shell_insert (GTK_MENU_SHELL (layout_menu), menuitem, i);
+            gtk_widget_show (GTK_WIDGET (menuitem));
         }
 
-        g_object_set_data_full (G_OBJECT (menuitem), LAYOUT_DATA_LABEL, label, g_free);
         g_object_set_data (G_OBJECT (menuitem), LAYOUT_DATA_GROUP, GINT_TO_POINTER (i));
-
-        g_signal_connect (G_OBJECT (menuitem), "activate", G_CALLBACK (layout_selected_cb), NULL);
-        gtk_menu_shell_append (GTK_MENU_SHELL (layout_menu), menuitem);
-        gtk_widget_show (GTK_WIDGET (menuitem));
+        menu_group = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (menuitem));
     }
+    g_hash_table_unref (old_items);
+
+    /* Configured layouts are at the top now, everything below them was removed from config */
+    menu_items = gtk_container_get_children (GTK_CONTAINER (layout_menu));
+    for (item = g_list_nth (menu_items, i); item; item = g_list_next (item))
+        gtk_widget_destroy (item->data);
+    g_list_free (menu_items);
 
-    g_object_unref (registry);
-    g_object_unref (config_item);
     g_object_unref (config);
     #else
     GSList *menu_group = NULL;
@@ -1745,6 +2111,106 @@ xkl_xevent_filter (GdkXEvent *xev, GdkEvent *event, gpointer  data)
     xkl_engine_filter_events (xkl_engine, xevent);
     return GDK_FILTER_CONTINUE;
 }
+
+static const gchar *
+get_layout_description (const gchar *layout, const gchar *variant)
+{
+    const gchar *description;
+    gchar *key;
+
+    if (!layout_descriptions_cache && !layout_descriptions)
+        load_layout_descriptions ();
+
+    if (layout_descriptions_cache)
+        return greeter_layout_cache_lookup (layout_descriptions_cache, layout, variant);
+
+    key = variant && *variant ? g_strdup_printf ("%s(%s)", layout, variant) : g_strdup (layout);
+    description = g_hash_table_lookup (layout_descriptions, key);
+    g_free (key);
+    return description;
+}
+
+typedef struct
+{
+    GHashTable *descriptions;
+    const gchar *layout;
+} LayoutDescriptionsFill;
+
+static void
+layout_descriptions_variant_cb (XklConfigRegistry *registry, const XklConfigItem *item, gpointer user_data)
+{
+    LayoutDescriptionsFill *fill = user_data;
+    g_hash_table_insert (fill->descriptions, g_strdup_printf ("%s(%s)", fill->layout, item->name),
+                         g_strdup (item->description));
+}
+
+static void
+layout_descriptions_layout_cb (XklConfigRegistry *registry, const XklConfigItem *item, gpointer user_data)
+{
+    LayoutDescriptionsFill *fill = user_data;
+    g_hash_table_insert (fill->descriptions, g_strdup (item->name), g_strdup (item->description));
+    fill->layout = item->name;
+    xkl_config_registry_foreach_layout_variant (registry, item->name, layout_descriptions_variant_cb, fill);
+}
+
+static void
+load_layout_descriptions (void)
+{
+    /* Descriptions are translated by libxklavier */
+    const gchar *locale = setlocale (LC_MESSAGES, NULL);
+    gchar *rules_path = get_xkb_rules_path ();
+    gboolean use_cache = rules_path && layout_descriptions_cache_filename;
+
+    if (use_cache)
+        layout_descriptions_cache = greeter_layout_cache_open (layout_descriptions_cache_filename, rules_path, locale);
+
+    if (!layout_descriptions_cache)
+    {
+        LayoutDescriptionsFill fill = {g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free), NULL};
+        XklConfigRegistry *registry;
+
+        GREETER_TRACE_BEGIN ("xkl_registry_load");
+        registry = xkl_config_registry_get_instance (xkl_engine);
+        if (xkl_config_registry_load (registry, FALSE))
+            xkl_config_registry_foreach_layout (registry, layout_descriptions_layout_cb, &fill);
+        else
+            g_warning ("Failed to load XKB configuration registry");
+        g_object_unref (registry);
+        GREETER_TRACE_END ("xkl_registry_load");
+
+        layout_descriptions = fill.descriptions;
+        if (use_cache && g_hash_table_size (layout_descriptions) > 0 &&
+            greeter_layout_cache_store (layout_descriptions_cache_filename, rules_path, locale, layout_descriptions))
+        {
+            layout_descriptions_cache = greeter_layout_cache_open (layout_descriptions_cache_filename, rules_path, locale);
+            if (layout_descriptions_cache)
+                g_clear_pointer (&layout_descriptions, g_hash_table_unref);
+        }
+    }
+    g_free (rules_path);
+}
+
+/* XKB rules file used by xkl_config_registry_load() */
+static gchar *
+get_xkb_rules_path (void)
+{
+    Display *display = xkl_engine_get_display (xkl_engine);
+    XklConfigRec *config = xkl_config_rec_new ();
+    gchar *rules = NULL;
+    gchar *path = NULL;
+
+    if (xkl_config_rec_get_from_root_window_property (config, XInternAtom (display, "_XKB_RULES_NAMES", False),
+                                                      &rules, xkl_engine) && rules && *rules)
+    {
+        gchar *name = g_strconcat (rules, ".xml", NULL);
+        path = g_path_is_absolute (name) ? g_strdup (name) : g_build_filename (XKB_RULES_DIR, name, NULL);
+        g_free (name);
+    }
+
+    g_free (rules);
+    g_object_unref (config);
+    return path;
+}
 #endif
 
 /* a11y indciator */
@@ -1819,6 +2285,9 @@ a11y_reader_cb (GtkCheckMenuItem *item, gpointer user_data)
 static void
 power_menu_cb (GtkWidget *menuitem, gpointer userdata)
 {
+    if (!build_power_ui ())
+        return;
+
     gtk_widget_set_sensitive (suspend_menuitem, lightdm_get_can_suspend ());
     gtk_widget_set_sensitive (hibernate_menuitem, lightdm_get_can_hibernate ());
     gtk_widget_set_sensitive (restart_menuitem, lightdm_get_can_restart ());
@@ -1855,6 +2324,18 @@ shutdown_cb (GtkWidget *widget, LightDMGreeter *greeter)
         lightdm_shutdown (NULL);
 }
 
+/* Shut down accelerator has to work before power menu items are built */
+static gboolean
+power_shutdown_accel_cb (GtkAccelGroup *accel_group, GObject *acceleratable,
+                         guint keyval, GdkModifierType modifier, gpointer user_data)
+{
+    /* Same conditions as for menu item accelerator */
+    if (!gtk_widget_is_sensitive (power_menuitem) || !gtk_widget_get_mapped (power_menuitem))
+        return FALSE;
+    shutdown_cb (NULL, greeter);
+    return TRUE;
+}
+
 static void
 set_login_button_label (LightDMGreeter *greeter, const gchar *username)
 {
@@ -1900,8 +2381,8 @@ set_user_background (const gchar *user_name)
         set_user_background_delayed_id = 0;
     }
 
-    if (!value)
-        greeter_background_set_custom_background (greeter_background, NULL);
+    if (!value || greeter_background_is_custom_background_ready (greeter_background, value))
+        greeter_background_set_custom_background (greeter_background, value);
     else
     {
         /* Small delay before changing background */
@@ -1911,6 +2392,63 @@ set_user_background (const gchar *user_name)
     }
 }
 
+static guint prefetch_user_backgrounds_id = 0;
+
+static void
+prefetch_user_background (GPtrArray *values,
+                          const gchar *user_name)
+{
+    LightDMUser *user;
+    const gchar *value;
+
+    if (!user_name)
+        return;
+    user = lightdm_user_list_get_user_by_name (lightdm_user_list_get_instance (), user_name);
+    value = user ? lightdm_user_get_background (user) : NULL;
+    if (value)
+        g_ptr_array_add (values, (gpointer) value);
+}
+
+/* Load backgrounds of users most likely to be selected next: neighbours in combo box and last user.
+ * Loading of backgrounds prefetched for previous selection is cancelled. */
+static gboolean
+prefetch_user_backgrounds_cb (gpointer data)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL (user_model);
+    GtkTreeIter active, iter;
+    GPtrArray *values = g_ptr_array_new ();
+    gchar *name;
+
+    prefetch_user_backgrounds_id = 0;
+
+    if (greeter_user_picker_get_active_iter (user_combo, &active))
+    {
+        iter = active;
+        if (gtk_tree_model_iter_next (model, &iter))
+            prefetch_user_background (values, greeter_user_model_get_name (user_model, &iter));
+        iter = active;
+        if (gtk_tree_model_iter_previous (model, &iter))
+            prefetch_user_background (values, greeter_user_model_get_name (user_model, &iter));
+    }
+
+    name = g_key_file_get_value (state, "greeter", "last-user", NULL);
+    prefetch_user_background (values, name);
+    g_free (name);
+
+    g_ptr_array_add (values, NULL);
+    greeter_background_prefetch_custom_backgrounds (greeter_background, (const gchar * const *) values->pdata);
+    g_ptr_array_free (values, TRUE);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+prefetch_user_backgrounds (void)
+{
+    if (!prefetch_user_backgrounds_id)
+        prefetch_user_backgrounds_id = g_idle_add_full (G_PRIORITY_LOW, prefetch_user_backgrounds_cb, NULL, NULL);
+}
+
 static void
 start_authentication (const gchar *username)
 {
@@ -1963,7 +2501,6 @@ start_authentication (const gchar *username)
 static void
 cancel_authentication (void)
 {
-    GtkTreeModel *model;
     GtkTreeIter iter;
     gboolean other = FALSE;
 
@@ -1986,16 +2523,8 @@ cancel_authentication (void)
     gtk_entry_set_visibility (password_entry, FALSE);
 
     /* Force refreshing the prompt_box for "Other" */
-    model = gtk_combo_box_get_model (user_combo);
-
-    if (gtk_combo_box_get_active_iter (user_combo, &iter))
-    {
-        gchar *user;
-
-        gtk_tree_model_get (GTK_TREE_MODEL (model), &iter, 0, &user, -1);
-        other = (g_strcmp0 (user, "*other") == 0);
-        g_free (user);
-    }
+    if (greeter_user_picker_get_active_iter (user_combo, &iter))
+        other = g_strcmp0 (greeter_user_model_get_name (user_model, &iter), "*other") == 0;
 
     /* Start a new login or return to the user list */
     if (other || lightdm_greeter_get_hide_users_hint (greeter))
@@ -2010,6 +2539,9 @@ start_session (void)
     gchar *language;
     gchar *session;
 
+    /* Compose root pixmap while preparing session */
+    greeter_background_prepare_xroot (greeter_background);
+
     language = get_language ();
     if (language)
         lightdm_greeter_set_language (greeter, language);
@@ -2042,7 +2574,7 @@ password_key_press_cb (GtkWidget *widget, GdkEventKey *event, gpointer user_data
     {
         gboolean available;
         GtkTreeIter iter;
-        GtkTreeModel *model = gtk_combo_box_get_model (user_combo);
+        GtkTreeModel *model = GTK_TREE_MODEL (user_model);
 
         /* Back to username_entry if it is available */
         if (event->keyval == GDK_KEY_Up &&
@@ -2052,7 +2584,7 @@ password_key_press_cb (GtkWidget *widget, GdkEventKey *event, gpointer user_data
             return TRUE;
         }
 
-        if (!gtk_combo_box_get_active_iter (user_combo, &iter))
+        if (!greeter_user_picker_get_active_iter (user_combo, &iter))
             return FALSE;
 
         if (event->keyval == GDK_KEY_Up)
@@ -2061,7 +2593,7 @@ password_key_press_cb (GtkWidget *widget, GdkEventKey *event, gpointer user_data
             available = gtk_tree_model_iter_next (model, &iter);
 
         if (available)
-            gtk_combo_box_set_active_iter (user_combo, &iter);
+            greeter_user_picker_set_active_iter (user_combo, &iter);
 
         return TRUE;
     }
@@ -2179,6 +2711,7 @@ set_displayed_user (LightDMGreeter *greeter, const gchar *username)
 
     set_login_button_label (greeter, username);
     set_user_background (username);
+    prefetch_user_backgrounds ();
     set_user_image (username);
     user = lightdm_user_list_get_user_by_name (lightdm_user_list_get_instance (), username);
     if (user)
@@ -2187,32 +2720,24 @@ set_displayed_user (LightDMGreeter *greeter, const gchar *username)
         set_session (lightdm_user_get_session (user));
     }
     else
-        set_language (lightdm_language_get_code (lightdm_get_language ()));
+        set_language (NULL);
     gtk_widget_set_tooltip_text (GTK_WIDGET (user_combo), user_tooltip);
     start_authentication (username);
     g_free (user_tooltip);
 }
 
-void user_combobox_active_changed_cb (GtkComboBox *widget, LightDMGreeter *greeter);
+void user_combobox_active_changed_cb (GreeterUserPicker *widget, LightDMGreeter *greeter);
 G_MODULE_EXPORT
 void
-user_combobox_active_changed_cb (GtkComboBox *widget, LightDMGreeter *greeter)
+user_combobox_active_changed_cb (GreeterUserPicker *widget, LightDMGreeter *greeter)
 {
-    GtkTreeModel *model;
     GtkTreeIter iter;
 
-    model = gtk_combo_box_get_model (user_combo);
-
-    if (gtk_combo_box_get_active_iter (user_combo, &iter))
-    {
-        gchar *user;
-
-        gtk_tree_model_get (GTK_TREE_MODEL (model), &iter, 0, &user, -1);
-
-        set_displayed_user (greeter, user);
+    if (user_events_applying)
+        return;
 
-        g_free (user);
-    }
+    if (greeter_user_picker_get_active_iter (user_combo, &iter))
+        set_displayed_user (greeter, greeter_user_model_get_name (user_model, &iter));
     set_message_label (LIGHTDM_MESSAGE_TYPE_INFO, NULL);
 }
 
@@ -2234,6 +2759,8 @@ login_cb (GtkWidget *widget)
         start_session ();
     else if (lightdm_greeter_get_in_authentication (greeter))
     {
+        /* Greeter keeps no unlocked copy of the response, but liblightdm copies it into
+         * its own message buffer, which is not locked since mlockall() was dropped */
         lightdm_greeter_respond (greeter, gtk_entry_get_text (password_entry));
         /* If we have questions pending, then we continue processing
          * those, until we are done. (Otherwise, authentication will
@@ -2324,6 +2851,7 @@ authentication_complete_cb (LightDMGreeter *greeter)
 
     if (lightdm_greeter_get_is_authenticated (greeter))
     {
+        greeter_background_prepare_xroot (greeter_background);
         if (prompted)
             start_session ();
         else
@@ -2354,80 +2882,124 @@ authentication_complete_cb (LightDMGreeter *greeter)
     }
 }
 
-static void
-user_added_cb (LightDMUserList *user_list, LightDMUser *user, LightDMGreeter *greeter)
+/* User list signals are queued and applied in batches: one views update per burst */
+typedef enum
 {
-    GtkTreeModel *model;
-    GtkTreeIter iter;
-    gboolean logged_in = FALSE;
+    USER_EVENT_ADDED,
+    USER_EVENT_CHANGED,
+    USER_EVENT_REMOVED
+} UserEventType;
 
-    model = gtk_combo_box_get_model (user_combo);
+typedef struct
+{
+    UserEventType type;
+    LightDMUser *user;
+} UserEvent;
 
-    logged_in = lightdm_user_get_logged_in (user);
+static GQueue user_events = G_QUEUE_INIT;
+static guint user_events_id = 0;
+/* Signals merged into batches with other signals, for debugging */
+static guint user_events_coalesced = 0;
+/* Removed active user is replaced after batch, authentication is not restarted in between */
+static gboolean user_events_applying = FALSE;
 
-    gtk_list_store_append (GTK_LIST_STORE (model), &iter);
-    gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-                        0, lightdm_user_get_name (user),
-                        1, lightdm_user_get_display_name (user),
-                        2, logged_in ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL,
-                        -1);
+static gboolean
+get_user_iter (const gchar *username, GtkTreeIter *iter)
+{
+    return greeter_user_model_find (user_model, username, iter);
+}
+
+static void
+apply_user_event (UserEvent *event)
+{
+    GtkTreeIter iter;
+    gboolean listed = get_user_iter (lightdm_user_get_name (event->user), &iter);
+
+    switch (event->type)
+    {
+    case USER_EVENT_ADDED:
+        /* Already listed users are reported again when user list is resynced */
+        if (!listed)
+        {
+            greeter_user_model_append_user (user_model, event->user, NULL);
+            break;
+        }
+        /* fall through */
+    case USER_EVENT_CHANGED:
+        /* Rows read values from LightDMUser, only views must be notified */
+        if (listed)
+            greeter_user_model_user_changed (user_model, &iter);
+        break;
+    case USER_EVENT_REMOVED:
+        if (listed)
+            greeter_user_model_remove (user_model, &iter);
+        break;
+    }
 }
 
 static gboolean
-get_user_iter (const gchar *username, GtkTreeIter *iter)
+apply_user_events_cb (gpointer data)
 {
-    GtkTreeModel *model;
+    UserEvent *event;
+    GtkTreeIter iter;
+    gboolean had_active;
+    guint n_events = g_queue_get_length (&user_events);
 
-    model = gtk_combo_box_get_model (user_combo);
+    user_events_id = 0;
+    had_active = greeter_user_picker_get_active_iter (user_combo, &iter);
 
-    if (!gtk_tree_model_get_iter_first (model, iter))
-        return FALSE;
-    do
+    /* Closed popup list is not updated for every row, picker keeps active row and open list state */
+    greeter_user_picker_freeze_view (user_combo);
+    user_events_applying = TRUE;
+    while ((event = g_queue_pop_head (&user_events)))
     {
-        gchar *name;
-        gboolean matched;
+        apply_user_event (event);
+        g_object_unref (event->user);
+        g_free (event);
+    }
+    user_events_applying = FALSE;
+    greeter_user_picker_thaw_view (user_combo);
 
-        gtk_tree_model_get (model, iter, 0, &name, -1);
-        matched = g_strcmp0 (name, username) == 0;
-        g_free (name);
-        if (matched)
-            return TRUE;
-    } while (gtk_tree_model_iter_next (model, iter));
+    /* Single re-selection pass: active user was removed */
+    if (had_active && !greeter_user_picker_get_active_iter (user_combo, &iter) &&
+        gtk_tree_model_get_iter_first (GTK_TREE_MODEL (user_model), &iter))
+        greeter_user_picker_set_active_iter (user_combo, &iter);
 
-    return FALSE;
+    user_events_coalesced += n_events - 1;
+    g_debug ("[Users] Applied %u user list changes, %u coalesced in total", n_events, user_events_coalesced);
+
+    return G_SOURCE_REMOVE;
 }
 
 static void
-user_changed_cb (LightDMUserList *user_list, LightDMUser *user, LightDMGreeter *greeter)
+queue_user_event (UserEventType type, LightDMUser *user)
 {
-    GtkTreeModel *model;
-    GtkTreeIter iter;
-    gboolean logged_in = FALSE;
+    UserEvent *event = g_new (UserEvent, 1);
+    event->type = type;
+    event->user = g_object_ref (user);
+    g_queue_push_tail (&user_events, event);
 
-    if (!get_user_iter (lightdm_user_get_name (user), &iter))
-        return;
-    logged_in = lightdm_user_get_logged_in (user);
+    /* Before relayout and redraw: whole burst is applied within one frame */
+    if (!user_events_id)
+        user_events_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, apply_user_events_cb, NULL, NULL);
+}
 
-    model = gtk_combo_box_get_model (user_combo);
+static void
+user_added_cb (LightDMUserList *user_list, LightDMUser *user, LightDMGreeter *greeter)
+{
+    queue_user_event (USER_EVENT_ADDED, user);
+}
 
-    gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-                        0, lightdm_user_get_name (user),
-                        1, lightdm_user_get_display_name (user),
-                        2, logged_in ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL,
-                        -1);
+static void
+user_changed_cb (LightDMUserList *user_list, LightDMUser *user, LightDMGreeter *greeter)
+{
+    queue_user_event (USER_EVENT_CHANGED, user);
 }
 
 static void
 user_removed_cb (LightDMUserList *user_list, LightDMUser *user)
 {
-    GtkTreeModel *model;
-    GtkTreeIter iter;
-
-    if (!get_user_iter (lightdm_user_get_name (user), &iter))
-        return;
-
-    model = gtk_combo_box_get_model (user_combo);
-    gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+    queue_user_event (USER_EVENT_REMOVED, user);
 }
 
 static void
@@ -2438,41 +3010,18 @@ load_user_list (void)
     GtkTreeIter iter;
     gchar *last_user;
     const gchar *selected_user;
-    gboolean logged_in = FALSE;
 
     g_signal_connect (lightdm_user_list_get_instance (), "user-added", G_CALLBACK (user_added_cb), greeter);
     g_signal_connect (lightdm_user_list_get_instance (), "user-changed", G_CALLBACK (user_changed_cb), greeter);
     g_signal_connect (lightdm_user_list_get_instance (), "user-removed", G_CALLBACK (user_removed_cb), NULL);
-    model = gtk_combo_box_get_model (user_combo);
+    model = GTK_TREE_MODEL (user_model);
     items = lightdm_user_list_get_users (lightdm_user_list_get_instance ());
+    /* Rows only reference users: names and labels are read when rows become visible */
     for (item = items; item; item = item->next)
-    {
-        LightDMUser *user = item->data;
-        logged_in = lightdm_user_get_logged_in (user);
-
-        gtk_list_store_append (GTK_LIST_STORE (model), &iter);
-        gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-                            0, lightdm_user_get_name (user),
-                            1, lightdm_user_get_display_name (user),
-                            2, logged_in ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL,
-                            -1);
-    }
+        greeter_user_model_append_user (user_model, item->data, NULL);
     if (lightdm_greeter_get_has_guest_account_hint (greeter))
-    {
-        gtk_list_store_append (GTK_LIST_STORE (model), &iter);
-        gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-                            0, "*guest",
-                            1, _("Guest Session"),
-                            2, PANGO_WEIGHT_NORMAL,
-                            -1);
-    }
-
-    gtk_list_store_append (GTK_LIST_STORE (model), &iter);
-    gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-                        0, "*other",
-                        1, _("Other..."),
-                        2, PANGO_WEIGHT_NORMAL,
-                        -1);
+        greeter_user_model_append_special (user_model, "*guest", _("Guest Session"), NULL);
+    greeter_user_model_append_special (user_model, "*other", _("Other..."), NULL);
 
     last_user = g_key_file_get_value (state, "greeter", "last-user", NULL);
 
@@ -2485,35 +3034,15 @@ load_user_list (void)
     else
         selected_user = NULL;
 
-    if (gtk_tree_model_get_iter_first (model, &iter))
+    if (selected_user && get_user_iter (selected_user, &iter))
     {
-        gchar *name;
-        gboolean matched = FALSE;
-
-        if (selected_user)
-        {
-            do
-            {
-                gtk_tree_model_get (model, &iter, 0, &name, -1);
-                matched = g_strcmp0 (name, selected_user) == 0;
-                g_free (name);
-                if (matched)
-                {
-                    gtk_combo_box_set_active_iter (user_combo, &iter);
-                    set_displayed_user (greeter, selected_user);
-                    break;
-                }
-            } while (gtk_tree_model_iter_next (model, &iter));
-        }
-        if (!matched)
-        {
-            gtk_tree_model_get_iter_first (model, &iter);
-            gtk_tree_model_get (model, &iter, 0, &name, -1);
-            gtk_combo_box_set_active_iter (user_combo, &iter);
-            set_displayed_user (greeter, name);
-            g_free (name);
-        }
-
+        greeter_user_picker_set_active_iter (user_combo, &iter);
+        set_displayed_user (greeter, selected_user);
+    }
+    else if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+        greeter_user_picker_set_active_iter (user_combo, &iter);
+        set_displayed_user (greeter, greeter_user_model_get_name (user_model, &iter));
     }
 
     g_free (last_user);
@@ -2580,12 +3109,52 @@ debug_log_handler (const gchar *log_domain, GLogLevelFlags log_level, const gcha
     g_free (new_domain);
 }
 
+static void
+greeter_connect_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    GError *error = NULL;
+
+    greeter_connected = lightdm_greeter_connect_to_daemon_finish (greeter, result, &error);
+    greeter_connecting = FALSE;
+    greeter_connected_time = g_get_monotonic_time ();
+    GREETER_TRACE_ASYNC_END ("lightdm_greeter_connect");
+
+    if (error)
+        g_warning ("Failed to connect to LightDM daemon: %s", error->message);
+    else
+        g_debug ("Connected to LightDM daemon in %" G_GINT64_FORMAT " ms", (greeter_connected_time - startup_time)/1000);
+    g_clear_error (&error);
+}
+
+static gboolean
+wait_for_greeter_connection (void)
+{
+    gint64 wait_start = g_get_monotonic_time ();
+
+    GREETER_TRACE_BEGIN ("wait_for_greeter_connection");
+    while (greeter_connecting && !quit_requested)
+        g_main_context_iteration (NULL, TRUE);
+    GREETER_TRACE_END ("wait_for_greeter_connection");
+
+    g_debug ("Waited for LightDM daemon: %" G_GINT64_FORMAT " ms", (g_get_monotonic_time () - wait_start)/1000);
+    return greeter_connected && !quit_requested;
+}
+
+static gboolean
+startup_complete_cb (gpointer user_data)
+{
+    GREETER_TRACE_END ("startup");
+    g_debug ("Startup complete in %" G_GINT64_FORMAT " ms, daemon connection took %" G_GINT64_FORMAT " ms",
+             (g_get_monotonic_time () - startup_time)/1000, (greeter_connected_time - startup_time)/1000);
+    GREETER_TRACE_SAVE ();
+    return G_SOURCE_REMOVE;
+}
+
 int
 main (int argc, char **argv)
 {
     GKeyFile *config;
     GtkBuilder *builder;
-    const GList *items, *item;
     GtkWidget *image;
     gchar *value, **values, *state_dir;
     GtkIconTheme *icon_theme;
@@ -2593,8 +3162,9 @@ main (int argc, char **argv)
     GError *error = NULL;
     Display *display;
 
-    /* Prevent memory from being swapped out, as we are dealing with passwords */
-    mlockall (MCL_CURRENT | MCL_FUTURE);
+    startup_time = g_get_monotonic_time ();
+    GREETER_TRACE_INIT ();
+    GREETER_TRACE_BEGIN ("startup");
 
     /* Disable global menus */
     g_unsetenv ("UBUNTU_MENUPROXY");
@@ -2613,17 +3183,31 @@ main (int argc, char **argv)
 
     g_unix_signal_add (SIGTERM, (GSourceFunc)sigterm_cb, NULL);
 
+    GREETER_TRACE_BEGIN ("config");
     config = g_key_file_new ();
     g_key_file_load_from_file (config, CONFIG_FILE, G_KEY_FILE_NONE, &error);
     if (error && !g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
         g_warning ("Failed to load configuration from %s: %s\n", CONFIG_FILE, error->message);
     g_clear_error (&error);
+    GREETER_TRACE_END ("config");
 
     if (g_key_file_get_boolean (config, "greeter", "allow-debugging", NULL))
         g_log_set_default_handler (debug_log_handler, NULL);
 
+    /* Connect to daemon first: the round-trip overlaps with everything up to wait_for_greeter_connection () */
+    greeter = lightdm_greeter_new ();
+    g_signal_connect (greeter, "show-prompt", G_CALLBACK (show_prompt_cb), NULL);
+    g_signal_connect (greeter, "show-message", G_CALLBACK (show_message_cb), NULL);
+    g_signal_connect (greeter, "authentication-complete", G_CALLBACK (authentication_complete_cb), NULL);
+    g_signal_connect (greeter, "autologin-timer-expired", G_CALLBACK (lightdm_greeter_authenticate_autologin), NULL);
+    GREETER_TRACE_ASYNC_BEGIN ("lightdm_greeter_connect");
+    greeter_connecting = TRUE;
+    lightdm_greeter_connect_to_daemon (greeter, NULL, greeter_connect_cb, NULL);
+
     /* init gtk */
+    GREETER_TRACE_BEGIN ("gtk_init");
     gtk_init (&argc, &argv);
+    GREETER_TRACE_END ("gtk_init");
 
     /* Disabling GtkInspector shortcuts.
        It is still possible to run GtkInspector with GTK_DEBUG=interactive.
@@ -2666,7 +3250,21 @@ main (int argc, char **argv)
     state_dir = g_build_filename (g_get_user_cache_dir (), "lightdm-gtk-greeter", NULL);
     g_mkdir_with_parents (state_dir, 0775);
     state_filename = g_build_filename (state_dir, "state", NULL);
-    g_free (state_dir);
+    #ifdef HAVE_LIBXKLAVIER
+    layout_descriptions_cache_filename = g_build_filename (state_dir, "xkb-layouts.cache", NULL);
+    #endif
+    user_image_cache_dir = g_build_filename (state_dir, USER_IMAGE_CACHE_SUBDIR, NULL);
+    greeter_io_broker_submit (user_image_cache_dir, 0, NULL, trim_user_image_cache, NULL, NULL, NULL, NULL, NULL);
+
+    /* Startup trace: LIGHTDM_GTK_GREETER_TRACE=<file> or allow-debugging, events recorded so far are kept */
+    const gchar *trace_env = g_getenv ("LIGHTDM_GTK_GREETER_TRACE");
+    gchar *trace_path = NULL;
+    if (trace_env && *trace_env)
+        trace_path = g_strdup (trace_env);
+    else if (trace_env || g_key_file_get_boolean (config, "greeter", "allow-debugging", NULL))
+        trace_path = g_build_filename (state_dir, "startup-trace.json", NULL);
+    GREETER_TRACE_SET_OUTPUT (trace_path);
+    g_free (trace_path);
 
     state = g_key_file_new ();
     g_key_file_load_from_file (state, state_filename, G_KEY_FILE_NONE, &error);
@@ -2674,33 +3272,9 @@ main (int argc, char **argv)
         g_warning ("Failed to load state from %s: %s\n", state_filename, error->message);
     g_clear_error (&error);
 
-    greeter = lightdm_greeter_new ();
-    g_signal_connect (greeter, "show-prompt", G_CALLBACK (show_prompt_cb), NULL);
-    g_signal_connect (greeter, "show-message", G_CALLBACK (show_message_cb), NULL);
-    g_signal_connect (greeter, "authentication-complete", G_CALLBACK (authentication_complete_cb), NULL);
-    g_signal_connect (greeter, "autologin-timer-expired", G_CALLBACK (lightdm_greeter_authenticate_autologin), NULL);
-    if (!lightdm_greeter_connect_sync (greeter, NULL))
-        return EXIT_FAILURE;
-
     /* Set default cursor */
     gdk_window_set_cursor (gdk_get_default_root_window (), gdk_cursor_new (GDK_LEFT_PTR));
 
-    /* Make the greeter behave a bit more like a screensaver if used as un/lock-screen by blanking the screen */
-    gchar* end_ptr = NULL;
-    int screensaver_timeout = 60;
-    value = g_key_file_get_value (config, "greeter", "screensaver-timeout", NULL);
-    if (value)
-        screensaver_timeout = g_ascii_strtoll (value, &end_ptr, 0);
-    g_free (value);
-
-    display = gdk_x11_display_get_xdisplay (gdk_display_get_default ());
-    if (lightdm_greeter_get_lock_hint (greeter))
-    {
-        XGetScreenSaver (display, &timeout, &interval, &prefer_blanking, &allow_exposures);
-        XForceScreenSaver (display, ScreenSaverActive);
-        XSetScreenSaver (display, screensaver_timeout, 0, ScreenSaverActive, DefaultExposures);
-    }
-
     /* Set GTK+ settings */
     value = g_key_file_get_value (config, "greeter", "theme-name", NULL);
     if (value)
@@ -2758,6 +3332,8 @@ main (int argc, char **argv)
     spawn_line_pid (INDICATOR_SERVICES_COMMAND, G_SPAWN_SEARCH_PATH, NULL);
     #endif
 
+    GREETER_TRACE_BEGIN ("builder");
+    gint64 builder_start_time = g_get_monotonic_time ();
     builder = gtk_builder_new ();
     if (!gtk_builder_add_from_string (builder, lightdm_gtk_greeter_ui,
                                       lightdm_gtk_greeter_ui_length, &error))
@@ -2766,6 +3342,11 @@ main (int argc, char **argv)
         return EXIT_FAILURE;
     }
     g_clear_error (&error);
+    GSList *builder_objects = gtk_builder_get_objects (builder);
+    g_debug ("UI loaded in %" G_GINT64_FORMAT " us: %u objects",
+             g_get_monotonic_time () - builder_start_time, g_slist_length (builder_objects));
+    g_slist_free (builder_objects);
+    GREETER_TRACE_END ("builder");
 
     /* Screen window */
     screen_overlay = GTK_OVERLAY (gtk_builder_get_object (builder, "screen_overlay"));
@@ -2773,9 +3354,16 @@ main (int argc, char **argv)
     /* Login window */
     login_window = GTK_WIDGET (gtk_builder_get_object (builder, "login_window"));
     user_image = GTK_IMAGE (gtk_builder_get_object (builder, "user_image"));
-    user_combo = GTK_COMBO_BOX (gtk_builder_get_object (builder, "user_combobox"));
+    user_combo = GREETER_USER_PICKER (gtk_builder_get_object (builder, "user_combobox"));
+    user_model = greeter_user_model_new ();
+    greeter_user_picker_set_model (user_combo, GTK_TREE_MODEL (user_model));
     username_entry = GTK_ENTRY (gtk_builder_get_object (builder, "username_entry"));
     password_entry = GTK_ENTRY (gtk_builder_get_object (builder, "password_entry"));
+    /* Password is kept in locked memory, so it is never swapped out */
+    GtkEntryBuffer *password_buffer = greeter_secure_entry_buffer_new ();
+    gtk_entry_set_buffer (password_entry, password_buffer);
+    g_object_unref (password_buffer);
+    g_debug ("Locked memory for passwords: %" G_GSIZE_FORMAT " bytes", greeter_secure_get_locked_bytes ());
     info_bar = GTK_INFO_BAR (gtk_builder_get_object (builder, "greeter_infobar"));
     message_label = GTK_LABEL (gtk_builder_get_object (builder, "message_label"));
     cancel_button = GTK_BUTTON (gtk_builder_get_object (builder, "cancel_button"));
@@ -2794,22 +3382,14 @@ main (int argc, char **argv)
     keyboard_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "keyboard_menuitem"));
     reader_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "reader_menuitem"));
     power_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "power_menuitem"));
+    power_menu = GTK_MENU (gtk_builder_get_object (builder, "power_menu"));
     layout_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "layout_menuitem"));
     layout_menu = GTK_MENU (gtk_builder_get_object (builder, "layout_menu"));
     clock_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "clock_menuitem"));
     host_menuitem = GTK_WIDGET (gtk_builder_get_object (builder, "host_menuitem"));
 
-    /* Power dialog */
-    power_window = GTK_WIDGET (gtk_builder_get_object (builder, "power_window"));
-    power_ok_button = GTK_BUTTON (gtk_builder_get_object (builder, "power_ok_button"));
-    power_cancel_button = GTK_BUTTON (gtk_builder_get_object (builder, "power_cancel_button"));
-    power_title = GTK_LABEL (gtk_builder_get_object (builder, "power_title"));
-    power_text = GTK_LABEL (gtk_builder_get_object (builder, "power_text"));
-    power_icon = GTK_IMAGE (gtk_builder_get_object (builder, "power_icon"));
-
     gtk_overlay_add_overlay (screen_overlay, login_window);
     gtk_overlay_add_overlay (screen_overlay, panel_window);
-    gtk_overlay_add_overlay (screen_overlay, power_window);
 
     gtk_accel_map_add_entry ("<Login>/a11y/font", GDK_KEY_F1, 0);
     gtk_accel_map_add_entry ("<Login>/a11y/contrast", GDK_KEY_F2, 0);
@@ -2817,7 +3397,9 @@ main (int argc, char **argv)
     gtk_accel_map_add_entry ("<Login>/a11y/reader", GDK_KEY_F4, 0);
     gtk_accel_map_add_entry ("<Login>/power/shutdown", GDK_KEY_F4, GDK_MOD1_MASK);
 
+    GREETER_TRACE_BEGIN ("init_indicators");
     init_indicators (config);
+    GREETER_TRACE_END ("init_indicators");
 
     /* Hide empty panel */
     GList *menubar_items = gtk_container_get_children (GTK_CONTAINER (menubar));
@@ -2841,8 +3423,8 @@ main (int argc, char **argv)
                 default_user_icon = g_strdup (value + 1);
             else
             {
-                default_user_pixbuf = gdk_pixbuf_new_from_file (value, &error);
-                if (!default_user_pixbuf)
+                default_user_surface = load_user_image_surface (value, 0, user_image_cache_dir, &error);
+                if (!default_user_surface)
                 {
                     g_warning ("Failed to load default user image: %s", error->message);
                     g_clear_error (&error);
@@ -2855,6 +3437,7 @@ main (int argc, char **argv)
     icon_theme = gtk_icon_theme_get_default ();
 
     /* Session menu */
+    GREETER_TRACE_BEGIN ("session_menu");
     if (gtk_widget_get_visible (session_menuitem))
     {
         if (gtk_icon_theme_has_icon (icon_theme, "document-properties-symbolic"))
@@ -2864,59 +3447,20 @@ main (int argc, char **argv)
         gtk_widget_show (session_badge);
         gtk_container_add (GTK_CONTAINER (session_menuitem), session_badge);
 
-        items = lightdm_get_sessions ();
-        GSList *sessions = NULL;
-        for (item = items; item; item = item->next)
-        {
-            LightDMSession *session = item->data;
-            GtkWidget *radiomenuitem;
-
-            radiomenuitem = gtk_radio_menu_item_new_with_label (sessions, lightdm_session_get_name (session));
-            g_object_set_data (G_OBJECT (radiomenuitem), SESSION_DATA_KEY, (gpointer) lightdm_session_get_key (session));
-            sessions = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (radiomenuitem));
-            g_signal_connect (G_OBJECT (radiomenuitem), "activate", G_CALLBACK (session_selected_cb), NULL);
-            gtk_menu_shell_append (GTK_MENU_SHELL (session_menu), radiomenuitem);
-            gtk_widget_show (GTK_WIDGET (radiomenuitem));
-        }
-        set_session (NULL);
+        /* Menu is hidden in UI file, so "show" is emitted on first popup too */
+        g_signal_connect (session_menu, "show", G_CALLBACK (session_menu_show_cb), NULL);
     }
+    GREETER_TRACE_END ("session_menu");
 
     /* Language menu */
+    GREETER_TRACE_BEGIN ("language_menu");
     if (gtk_widget_get_visible (language_menuitem))
     {
-        items = lightdm_get_languages ();
-        GSList *languages = NULL;
-        for (item = items; item; item = item->next)
-        {
-            LightDMLanguage *language = item->data;
-            const gchar *country, *code;
-            gchar *label;
-            GtkWidget *radiomenuitem;
-
-            country = lightdm_language_get_territory (language);
-            if (country)
-                label = g_strdup_printf ("%s - %s", lightdm_language_get_name (language), country);
-            else
-                label = g_strdup (lightdm_language_get_name (language));
-
-            code = lightdm_language_get_code (language);
-            gchar *modifier = strchr (code, '@');
-            if (modifier != NULL)
-            {
-                gchar *label_new = g_strdup_printf ("%s [%s]", label, modifier+1);
-                g_free (label);
-                label = label_new;
-            }
-
-            radiomenuitem = gtk_radio_menu_item_new_with_label (languages, label);
-            g_object_set_data (G_OBJECT (radiomenuitem), LANGUAGE_DATA_CODE, (gpointer) code);
-            languages = gtk_radio_menu_item_get_group (GTK_RADIO_MENU_ITEM (radiomenuitem));
-            g_signal_connect (G_OBJECT (radiomenuitem), "activate", G_CALLBACK (language_selected_cb), NULL);
-            gtk_menu_shell_append (GTK_MENU_SHELL (language_menu), radiomenuitem);
-            gtk_widget_show (GTK_WIDGET (radiomenuitem));
-        }
+        /* Menu is hidden in UI file, so "show" is emitted on first popup too */
+        g_signal_connect (language_menu, "show", G_CALLBACK (language_menu_show_cb), NULL);
         set_language (NULL);
     }
+    GREETER_TRACE_END ("language_menu");
 
     /* a11y menu */
     if (gtk_widget_get_visible (a11y_menuitem))
@@ -2950,15 +3494,14 @@ main (int argc, char **argv)
         gtk_widget_show (image);
         gtk_container_add (GTK_CONTAINER (power_menuitem), image);
 
-        suspend_menuitem = (GTK_WIDGET (gtk_builder_get_object (builder, "suspend_menuitem")));
-        hibernate_menuitem = (GTK_WIDGET (gtk_builder_get_object (builder, "hibernate_menuitem")));
-        restart_menuitem = (GTK_WIDGET (gtk_builder_get_object (builder, "restart_menuitem")));
-        shutdown_menuitem = (GTK_WIDGET (gtk_builder_get_object (builder, "shutdown_menuitem")));
-
+        gtk_accel_group_connect_by_path (GTK_ACCEL_GROUP (gtk_builder_get_object (builder, "power_accelgroup")),
+                                         "<Login>/power/shutdown",
+                                         g_cclosure_new (G_CALLBACK (power_shutdown_accel_cb), NULL, NULL));
         g_signal_connect (G_OBJECT (power_menuitem),"activate", G_CALLBACK (power_menu_cb), NULL);
     }
 
     /* Layout menu */
+    GREETER_TRACE_BEGIN ("layout_menu");
     if (gtk_widget_get_visible (layout_menuitem))
     {
         #ifdef HAVE_LIBXKLAVIER
@@ -2987,6 +3530,7 @@ main (int argc, char **argv)
         update_layouts_menu ();
         update_layouts_menu_state ();
     }
+    GREETER_TRACE_END ("layout_menu");
 
     /* Host label */
     if (gtk_widget_get_visible (host_menuitem))
@@ -3022,6 +3566,32 @@ main (int argc, char **argv)
 
     /* Background */
     greeter_background = greeter_background_new (GTK_WIDGET (screen_overlay));
+    greeter_background_set_cache_dir (greeter_background, state_dir);
+    g_free (state_dir);
+
+    GError *cache_size_error = NULL;
+    gint cache_size = g_key_file_get_integer (config, "greeter", "user-background-cache-size", &cache_size_error);
+    if (cache_size_error || cache_size < 0)
+        cache_size = USER_BACKGROUND_CACHE_SIZE;
+    g_clear_error (&cache_size_error);
+    greeter_background_set_custom_cache_limit (greeter_background, (gsize)cache_size*1024*1024);
+
+    GError *memory_limit_error = NULL;
+    gint memory_limit = g_key_file_get_integer (config, "greeter", "background-memory-limit", &memory_limit_error);
+    if (!memory_limit_error && memory_limit >= 0)
+        greeter_background_set_memory_limit (greeter_background, (gsize)memory_limit*1024*1024);
+    g_clear_error (&memory_limit_error);
+
+    /* Remote X server: do not send images over network on every expose */
+    GError *server_images_error = NULL;
+    gboolean server_images = g_key_file_get_boolean (config, "greeter", "server-side-backgrounds", &server_images_error);
+    if (server_images_error)
+    {
+        const gchar *display_name = gdk_display_get_name (gdk_display_get_default ());
+        server_images = display_name && display_name[0] != ':' && !g_str_has_prefix (display_name, "unix:");
+    }
+    g_clear_error (&server_images_error);
+    greeter_background_set_server_images (greeter_background, server_images);
 
     value = g_key_file_get_value (config, "greeter", "active-monitor", NULL);
     greeter_background_set_active_monitor_config (greeter_background, value ? value : "#cursor");
@@ -3072,7 +3642,32 @@ main (int argc, char **argv)
     greeter_background_add_accel_group (greeter_background, GTK_ACCEL_GROUP (gtk_builder_get_object (builder, "a11y_accelgroup")));
     greeter_background_add_accel_group (greeter_background, GTK_ACCEL_GROUP (gtk_builder_get_object (builder, "power_accelgroup")));
 
+    GREETER_TRACE_BEGIN ("greeter_background_connect");
     greeter_background_connect (greeter_background, gdk_screen_get_default ());
+    GREETER_TRACE_END ("greeter_background_connect");
+
+    /* Everything below depends on daemon hints */
+    if (!wait_for_greeter_connection ())
+        return quit_requested ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    /* Make the greeter behave a bit more like a screensaver if used as un/lock-screen by blanking the screen */
+    gchar* end_ptr = NULL;
+    int screensaver_timeout = 60;
+    value = g_key_file_get_value (config, "greeter", "screensaver-timeout", NULL);
+    if (value)
+        screensaver_timeout = g_ascii_strtoll (value, &end_ptr, 0);
+    g_free (value);
+
+    display = gdk_x11_display_get_xdisplay (gdk_display_get_default ());
+    if (lightdm_greeter_get_lock_hint (greeter))
+    {
+        XGetScreenSaver (display, &timeout, &interval, &prefer_blanking, &allow_exposures);
+        XForceScreenSaver (display, ScreenSaverActive);
+        XSetScreenSaver (display, screensaver_timeout, 0, ScreenSaverActive, DefaultExposures);
+    }
+
+    if (gtk_widget_get_visible (session_menuitem))
+        set_session (NULL);
 
     if (lightdm_greeter_get_hide_users_hint (greeter))
     {
@@ -3081,7 +3676,9 @@ main (int argc, char **argv)
     }
     else
     {
+        GREETER_TRACE_BEGIN ("load_user_list");
         load_user_list ();
+        GREETER_TRACE_END ("load_user_list");
         gtk_widget_hide (GTK_WIDGET (cancel_button));
         gtk_widget_show (GTK_WIDGET (user_combo));
     }
@@ -3147,7 +3744,14 @@ main (int argc, char **argv)
 
     gtk_widget_show (GTK_WIDGET (screen_overlay));
 
-    gtk_main ();
+    /* Startup is complete when main loop becomes idle for the first time */
+    gdk_threads_add_idle_full (G_PRIORITY_LOW, (GSourceFunc) startup_complete_cb, NULL, NULL);
+
+    if (!quit_requested)
+        gtk_main ();
+
+    /* Save again: background loading may finish after first idle */
+    GREETER_TRACE_SAVE ();
 
     g_slist_foreach (pids_to_close, (GFunc)close_pid, NULL);
 